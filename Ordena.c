@@ -0,0 +1,1128 @@
+/* Ordenación de un vector: programa principal
+ *
+ * Ejecuta y mide cualquier subconjunto de los métodos secuenciales y paralelos de la tabla de metodos.c sobre el mismo
+ * vector y con el mismo código de medida, comprobando que todos obtienen el mismo resultado.
+ *
+ * Compilación: gcc -W -O2 Ordena.c metodos.c utilidades.c generador.c adaptativo.c clavevalor.c tipos.c torneo.c seleccion.c incremental.c
+ *              ejecutor.c externo.c instrumentacion.c OrdenaVector.c OrdenaVectorOMP.c -o Ordena -fopenmp -lm
+ * Ejecución: ./Ordena [-n componentes] [-m rango] [-s semilla] [-d distribuciones] [-t hilos] [-r repeticiones] [-w calentamiento]
+ *                     [-k métodos] [-x modo] [-u umbrales] [-f formato] [-o fichero] [-b] [-g]
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <omp.h>
+#include "ordena.h"
+#include "instrumentacion.h"
+
+#define M 100			// ==> Rango de valores de los componentes por defecto: [0, M[ (opción -m)
+#define VECT_SIZE 20000 // N.º componentes del vector que se quiere ordenar por defecto (opción -n)
+#define SEMILLA 1		// Semilla por defecto (opción -s): sin -s todas las ejecuciones miden los mismos vectores
+#define BLOQUE_GENERACION (1 << 22) // Componentes que genera de una vez la prueba de la ordenación externa
+#define ORDENACION_PEQUENA (1 << 15) // Tamaño de las ordenaciones pequeñas repetidas de la prueba de ejecutores...
+#define REPETIDAS_PEQUENAS 1000		// ...y cuántas se hacen seguidas en cada repetición
+
+// Formatos de salida de los resultados (opción -f)
+#define TEXTO 0
+#define CSV 1
+#define JSON 2
+
+// Variables globales
+float *vini, *vord0, *vord; // vector desordenado, vector de referencia y vector que se ordenará, respectivamente
+int repeticiones = 1, calentamiento = 0, formato = TEXTO; // configuración de la medida (opciones -r, -w y -f)
+FILE *salida;			 // resultados en formato csv o json
+double *tiempos;		 // tiempo (milisegundos) de cada repetición del método que se está midiendo
+struct metodo *referencia; // método cuyo resultado se ha guardado en vord0 para el tamaño actual (NULL si todavía ninguno)
+const char *distribucion = "uniforme"; // distribución del vector actual, tal como se ha pedido en -d (con su parámetro)
+
+/* Tiempos de referencia para calcular la aceleración: los de los métodos secuenciales y los de los paralelos con un solo
+ * hilo, que se usan cuando el método no tiene equivalente secuencial */
+struct tiempo_referencia
+{
+	char metodo[16];
+	char distribucion[32];
+	int size;
+	double tiempo; // milisegundos
+};
+struct tiempo_referencia *referencias = NULL;
+int nreferencias = 0, capacidad_referencias = 0;
+
+void anota_referencia(const char *metodo, int size, double tiempo)
+{
+	if (nreferencias == capacidad_referencias)
+	{
+		capacidad_referencias = (capacidad_referencias == 0) ? 64 : 2 * capacidad_referencias;
+		referencias = (struct tiempo_referencia *)realloc(referencias, capacidad_referencias * sizeof(struct tiempo_referencia));
+	}
+	snprintf(referencias[nreferencias].metodo, sizeof(referencias[nreferencias].metodo), "%s", metodo);
+	snprintf(referencias[nreferencias].distribucion, sizeof(referencias[nreferencias].distribucion), "%s", distribucion);
+	referencias[nreferencias].size = size;
+	referencias[nreferencias].tiempo = tiempo;
+	nreferencias++;
+}
+
+int compara_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+// Mediana de los tiempos de referencia anotados para (metodo, size) con la distribución actual, o NAN si no hay ninguno
+double busca_referencia(const char *metodo, int size)
+{
+	int i, n = 0;
+	double *t = (double *)malloc((nreferencias + 1) * sizeof(double)), mediana = NAN;
+	for (i = 0; i < nreferencias; i++)
+		if ((referencias[i].size == size) && (strcmp(referencias[i].metodo, metodo) == 0) &&
+			(strcmp(referencias[i].distribucion, distribucion) == 0))
+			t[n++] = referencias[i].tiempo;
+	if (n > 0)
+	{
+		qsort(t, n, sizeof(double), compara_double);
+		mediana = (n % 2) ? t[n / 2] : (t[n / 2 - 1] + t[n / 2]) / 2;
+	}
+	free(t);
+	return mediana;
+}
+
+// Tiempo de referencia de un método paralelo: su método secuencial (si se ha medido) o, si no, él mismo con un hilo
+double tiempo_secuencial(const struct metodo *m, int size)
+{
+	double t = NAN;
+	if (m->secuencial != NULL)
+		t = busca_referencia(m->secuencial, size);
+	return isnan(t) ? busca_referencia(m->nombre, size) : t;
+}
+
+// Una fila de resultados por repetición: tiempo, elementos por segundo, aceleración y eficiencia (vacías si no hay referencia)
+void escribe_fila(FILE *f, int formato, const char *metodo, int size, int hilos, int rep, double tiempo, double referencia)
+{
+	double aceleracion = referencia / tiempo, eficiencia = aceleracion / hilos;
+	if (formato == CSV)
+	{
+		fprintf(f, "%s,%s,%d,%d,%d,%.6f,%.1f,", metodo, distribucion, size, hilos, rep, tiempo, size / (tiempo / 1000));
+		if (isnan(referencia))
+			fprintf(f, ",\n");
+		else
+			fprintf(f, "%.4f,%.4f\n", aceleracion, eficiencia);
+	}
+	else
+	{ // Una línea JSON por fila (JSON Lines)
+		fprintf(f, "{\"metodo\": \"%s\", \"distribucion\": \"%s\", \"n\": %d, \"hilos\": %d, \"repeticion\": %d, \"tiempo_ms\": %.6f, "
+				   "\"elementos_por_s\": %.1f, ", metodo, distribucion, size, hilos, rep, tiempo, size / (tiempo / 1000));
+		if (isnan(referencia))
+			fprintf(f, "\"aceleracion\": null, \"eficiencia\": null}\n");
+		else
+			fprintf(f, "\"aceleracion\": %.4f, \"eficiencia\": %.4f}\n", aceleracion, eficiencia);
+	}
+}
+
+/* Mínimo, mediana, percentil 95 (por rango más cercano) y desviación típica de n tiempos. Deja tiempos ordenado. */
+void estadisticas(double tiempos[], int n, double *minimo, double *mediana, double *p95, double *desviacion)
+{
+	int i;
+	double media = 0, suma2 = 0;
+	qsort(tiempos, n, sizeof(double), compara_double);
+	for (i = 0; i < n; i++)
+		media += tiempos[i] / n;
+	for (i = 0; i < n; i++)
+		suma2 += (tiempos[i] - media) * (tiempos[i] - media);
+	*minimo = tiempos[0];
+	*mediana = (n % 2) ? tiempos[n / 2] : (tiempos[n / 2 - 1] + tiempos[n / 2]) / 2;
+	*p95 = tiempos[(int)ceil(0.95 * n) - 1];
+	*desviacion = (n > 1) ? sqrt(suma2 / (n - 1)) : 0;
+}
+
+void uso(const char *programa)
+{
+	int i;
+	printf("Uso: %s [-n componentes] [-m rango] [-s semilla] [-d distribuciones] [-t hilos] [-r repeticiones] [-w calentamiento]\n"
+		   "       [-k métodos] [-x modo] [-u umbrales] [-f formato] [-o fichero] [-b] [-g] [-i entrada] [-e salida] [-l memoria]\n", programa);
+	printf("  -n  N.º de componentes del vector (por defecto %d); con -b, el mayor tamaño del barrido\n", VECT_SIZE);
+	printf("  -m  Rango de valores de los componentes: [0, m[ (por defecto %d)\n", M);
+	printf("  -s  Semilla del generador (por defecto %d). El vector solo depende de la semilla, no del n.º de hilos\n", SEMILLA);
+	printf("  -d  Distribuciones separadas por comas, cada una con un parámetro opcional tras ':' (por defecto uniforme):\n"
+		   "      uniforme, ordenado, inverso, casi[:intercambios], pocos[:valores], iguales, zipf[:valores], gauss, organo, ceros[:1 NaN de cada]\n");
+	printf("  -t  N.º de hilos de los métodos paralelos (por defecto, los de OpenMP)\n");
+	printf("  -r  Repeticiones medidas de cada método (por defecto 1)\n");
+	printf("  -w  Repeticiones de calentamiento que no se miden (por defecto 0)\n");
+	printf("  -k  Métodos separados por comas (por defecto todos). Se ejecutan primero los secuenciales y el primero\n"
+		   "      que se ejecuta es la referencia con la que se comparan los demás\n");
+	printf("  -x  metodos: ordenar con los métodos de -k (por defecto); nucleos: medir la red de ordenación y la mezcla vectorizada;\n"
+		   "      calibra: medir los umbrales del método adaptativo (auto) hasta -n componentes e imprimirlos como opción -u;\n"
+		   "      clavevalor: medir la ordenación de claves con valores e índices (argsort) con cada motor;\n"
+		   "      tipos: medir los motores genéricos con cada tipo frente a los métodos de solo float y qsort;\n"
+		   "      topk: medir la selección del k-ésimo y el orden parcial de los k menores (k = 10 ... 10^6) frente a ordenar todo;\n"
+		   "      lotes: medir la inserción de lotes de n/10^4 a n componentes en un vector ordenado frente a reordenarlo;\n"
+		   "      ejecutores: medir los métodos portados y copiarVector con directivas, con el ejecutor OpenMP y con el de robo;\n"
+		   "      externo: ordenar el fichero -i en -e (o en el mismo) o, sin -i, medir la ordenación externa de -n componentes\n");
+	printf("  -u  Umbrales del método adaptativo: pequeno,casi,tramo,base,duplicados (por defecto %d,%d,%d,%d,%g)\n",
+		   umbrales.pequeno, umbrales.casi, umbrales.tramo, umbrales.base, umbrales.duplicados);
+	printf("  -f  texto (por defecto), csv o json (una fila por método, tamaño, hilos y repetición)\n");
+	printf("  -o  Fichero de resultados para csv y json (por defecto, la salida estándar)\n");
+	printf("  -b  Barrido: tamaños 10^3, 10^4, ... hasta -n y, para los métodos paralelos, de 1 a %d hilos\n", omp_get_num_procs());
+	printf("  -g  Pedir páginas grandes (transparent huge pages) para los vectores y buffers de 2 MB o más\n");
+	printf("  -i  Fichero de floats en binario que ordena -x externo\n");
+	printf("  -e  Fichero donde -x externo deja el resultado (por defecto, el mismo de -i)\n");
+	printf("  -l  MB de memoria de la ordenación externa (por defecto %d); los ficheros temporales van a $TMPDIR o /tmp\n", MEMORIA_EXTERNO);
+	printf("\nMétodos:\n");
+	for (i = 0; i < nmetodos; i++)
+		if (metodos[i].max_size > 0)
+			printf("  %-4s %-36s %-11s hasta %ld componentes\n", metodos[i].nombre, metodos[i].descripcion, metodos[i].complejidad, metodos[i].max_size);
+		else
+			printf("  %-4s %-36s %s\n", metodos[i].nombre, metodos[i].descripcion, metodos[i].complejidad);
+}
+
+// Mide por separado los núcleos de los métodos mejorados: red de ordenación y mezcla vectorizada (sin contar las copias)
+void mide_nucleos(int size)
+{
+	const char *nucleos[] = {"la red de ordenación", "inserción", "la mezcla vectorizada", "la mezcla escalar"};
+	int i, k, r;
+	double t, minimo, mediana, p95, desviacion;
+	float *pares = (float *)malloc((size / 2 + 1) * sizeof(float)), *impares = (float *)malloc((size / 2 + 1) * sizeof(float));
+
+	// Las posiciones pares e impares de un vector ordenado son dos secuencias ordenadas que se entrelazan
+	copiarVector(vord0, vini, size);
+	ord_parQ(vord0, size);
+	for (i = 0; i < size; i++)
+		if (i % 2 == 0)
+			pares[i / 2] = vord0[i];
+		else
+			impares[i / 2] = vord0[i];
+
+	printf("=================================================================\n");
+	printf("Núcleos de ordenación (%s), bloques de %d componentes para las redes\n", hay_avx2() ? "AVX2" : "escalar", RED_MAX);
+	for (k = 0; k < 4; k++)
+	{
+		for (r = -calentamiento; r < repeticiones; r++)
+		{
+			if (k < 2)
+				copiarVector(vord, vini, size);
+			t = omp_get_wtime();
+			switch (k)
+			{
+			case 0:
+				for (i = 0; i + RED_MAX <= size; i += RED_MAX)
+					ordena_red(vord + i, RED_MAX);
+				break;
+			case 1:
+				for (i = 0; i + RED_MAX <= size; i += RED_MAX)
+					ordena_insercion(vord + i, RED_MAX);
+				break;
+			case 2:
+				mezcla_simd(pares, (size + 1) / 2, impares, size / 2, vord);
+				break;
+			case 3:
+				mezcla_buffer(pares, (size + 1) / 2, impares, size / 2, vord);
+				break;
+			}
+			t = omp_get_wtime() - t;
+			if (r >= 0)
+				tiempos[r] = 1000 * t;
+		}
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+		printf("\nTiempo empleado por %s: mínimo %0.8f, mediana %0.8f, p95 %0.8f, desviación %0.8f milisegundos\n",
+			   nucleos[k], minimo, mediana, p95, desviacion);
+	}
+	printf("=================================================================\n");
+	free(pares);
+	free(impares);
+}
+
+/* Mide la ordenación clave-valor: índices de la ordenación (argsort) con cada motor y con palabras empaquetadas de 64 bits
+ * (clave, índice), y claves con valores de 32 y de 64 bits. Comprueba en todos los casos que la permutación es estable, y
+ * además con un vector de +0 y -0 al azar.
+ */
+void mide_clavevalor(int size)
+{
+	const char *pruebas[] = {"los índices con el motor de mezcla", "los índices con el motor de base", "los índices con el motor par-impar",
+							 "los índices con palabras (clave, índice) de 64 bits", "clave-valor de 32 bits con el motor de base",
+							 "clave-valor de 64 bits con el motor de base"};
+	int i, k, r, error, hecho = TRUE;
+	double t, minimo, mediana, p95, desviacion;
+	uint32_t *indices = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+	uint64_t *valores = (uint64_t *)reservaAlineada((long)size * sizeof(uint64_t));
+
+	if ((indices == NULL) || (valores == NULL))
+	{
+		printf("No hay memoria para la prueba clave-valor con %d componentes\n", size);
+		liberaAlineada(indices);
+		liberaAlineada(valores);
+		return;
+	}
+	printf("=================================================================\n");
+	printf("Ordenación clave-valor (claves y valores en vectores separados), %d componentes\n", size);
+	for (k = 0; k < 6; k++)
+	{
+		for (r = -calentamiento; r < repeticiones; r++)
+		{
+			if (k >= 4)
+				for (i = 0; i < size; i++)
+				{
+					vord[i] = vini[i];
+					indices[i] = i;
+					valores[i] = 3 * (uint64_t)i + 0x100000000ULL; // un valor que no cabe en 32 bits, del que sale el índice
+				}
+			t = omp_get_wtime();
+			if (k < 3)
+				hecho = ordenaIndices(vini, indices, size, k);
+			else if (k == 3)
+				hecho = ordenaIndicesEmpaquetado(vini, indices, size);
+			else if (k == 4)
+				hecho = ordenaClaveValor(vord, indices, size, CV_BASE);
+			else
+				hecho = ordenaClaveValor64(vord, valores, size, CV_BASE);
+			t = omp_get_wtime() - t;
+			if (r >= 0)
+				tiempos[r] = 1000 * t;
+		}
+		if (!hecho)
+		{
+			printf("\nNo hay memoria para ordenar %s\n", pruebas[k]);
+			continue;
+		}
+		if (k == 5)
+			for (i = 0; i < size; i++)
+				indices[i] = (uint32_t)((valores[i] - 0x100000000ULL) / 3);
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+		printf("\nTiempo empleado por %s: mínimo %0.8f, mediana %0.8f, p95 %0.8f, desviación %0.8f milisegundos\n",
+			   pruebas[k], minimo, mediana, p95, desviacion);
+		if ((error = compruebaIndices(vini, indices, size)) >= 0)
+			printf("La permutación obtenida no ordena las claves de forma estable (posición %d)\n", error);
+		else if (k >= 4)
+		{ // Las claves también tienen que haber quedado ordenadas, cada una con su valor
+			for (i = 0; (i < size) && (vord[i] == vini[indices[i]]); i++)
+				;
+			if (i < size)
+				printf("La clave de la posición %d no corresponde a su valor\n", i);
+		}
+	}
+	// Con +0 y -0, iguales para < pero con otros bits, todos los motores tienen que seguir dejando los índices en orden
+	if (generaVector(vord, size, DIST_CEROS, 1, 0, -1))
+		for (k = 0; k < 4; k++)
+		{
+			hecho = (k < 3) ? ordenaIndices(vord, indices, size, k) : ordenaIndicesEmpaquetado(vord, indices, size);
+			if (hecho && ((error = compruebaIndices(vord, indices, size)) >= 0))
+				printf("\nCon +0 y -0, %s no da una permutación estable (posición %d)\n", pruebas[k], error);
+		}
+	printf("=================================================================\n");
+	liberaAlineada(indices);
+	liberaAlineada(valores);
+}
+
+int compara_float(const void *a, const void *b)
+{
+	float x = *(const float *)a, y = *(const float *)b;
+	return (x > y) - (x < y);
+}
+
+/* Mide una ordenación de un vector buf de size componentes del tipo indicado: antes de cada repetición se rellena a partir
+ * de vini con la expresión conversion (de vini[i]), se ordena con la sentencia ordenacion y al final se comprueba con
+ * desorden (la función primer_desorden del mismo tipo y orden).
+ */
+#define MIDE_TIPO(nombre, TIPO, buf, conversion, ordenacion, desorden)                                                    \
+	{                                                                                                                     \
+		TIPO *v = (TIPO *)(buf);                                                                                          \
+		for (r = -calentamiento; r < repeticiones; r++)                                                                   \
+		{                                                                                                                 \
+			_Pragma("omp parallel for schedule(static)") for (i = 0; i < size; i++) v[i] = (TIPO)(conversion);            \
+			t = omp_get_wtime();                                                                                          \
+			ordenacion;                                                                                                   \
+			t = omp_get_wtime() - t;                                                                                      \
+			if (r >= 0)                                                                                                   \
+				tiempos[r] = 1000 * t;                                                                                    \
+		}                                                                                                                 \
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);                                        \
+		printf("\nTiempo empleado por %s: mínimo %0.8f, mediana %0.8f, p95 %0.8f, desviación %0.8f milisegundos\n", nombre, \
+			   minimo, mediana, p95, desviacion);                                                                         \
+		if ((error = desorden(v, size)) >= 0)                                                                             \
+			printf("El vector no está ordenado (posición %d)\n", error);                                                  \
+	}
+
+/* Compara los motores genéricos de tipos.c con los métodos de solo float (la versión float de la plantilla usa los mismos
+ * núcleos vectorizados, así que tiene que tardar lo mismo que ord_parAm) y con qsort, que compara a través de un puntero a
+ * función, y mide los mismos motores con los demás tipos y órdenes.
+ */
+void mide_tipos(int size)
+{
+	int i, r, error;
+	double t, minimo, mediana, p95, desviacion;
+	void *buf = reservaAlineada((long)size * sizeof(double));
+
+	if (buf == NULL)
+	{
+		printf("No hay memoria para la prueba de tipos con %d componentes\n", size);
+		return;
+	}
+	printf("=================================================================\n");
+	printf("Motores genéricos por tipo, %d componentes, %d hilos\n", size, omp_get_max_threads());
+	MIDE_TIPO("ord_parAm (solo float)", float, buf, vini[i], ord_parAm(v, size), primer_desorden_f32)
+	MIDE_TIPO("ordena_mezcla_f32", float, buf, vini[i], ordena_mezcla_f32(v, size), primer_desorden_f32)
+	MIDE_TIPO("ord_parDb (solo float)", float, buf, vini[i], ord_parDb(v, size), primer_desorden_f32)
+	MIDE_TIPO("ordena_parimpar_f32", float, buf, vini[i], ordena_parimpar_f32(v, size), primer_desorden_f32)
+	MIDE_TIPO("qsort (float, comparación por puntero a función)", float, buf, vini[i],
+			  qsort(v, size, sizeof(float), compara_float), primer_desorden_f32)
+	MIDE_TIPO("ordena_mezcla_f32_total (con NaN)", float, buf, (i % 100 == 0) ? NAN : vini[i], ordena_mezcla_f32_total(v, size),
+			  primer_desorden_f32_total)
+	MIDE_TIPO("ordena_mezcla_f32_desc", float, buf, vini[i], ordena_mezcla_f32_desc(v, size), primer_desorden_f32_desc)
+	MIDE_TIPO("ordena_mezcla_f64", double, buf, vini[i], ordena_mezcla_f64(v, size), primer_desorden_f64)
+	MIDE_TIPO("ordena_mezcla_f64_abs", double, buf, vini[i] - 50, ordena_mezcla_f64_abs(v, size), primer_desorden_f64_abs)
+	MIDE_TIPO("ordena_mezcla_i32", int32_t, buf, vini[i] * 1000 - 50000, ordena_mezcla_i32(v, size), primer_desorden_i32)
+	MIDE_TIPO("ordena_mezcla_i64", int64_t, buf, (double)vini[i] * 1e12 - 5e13, ordena_mezcla_i64(v, size), primer_desorden_i64)
+	MIDE_TIPO("ordena_parimpar_i64_desc", int64_t, buf, (double)vini[i] * 1e12 - 5e13, ordena_parimpar_i64_desc(v, size),
+			  primer_desorden_i64_desc)
+	MIDE_TIPO("ordena_mezcla_u64", uint64_t, buf, mezcla64(i), ordena_mezcla_u64(v, size), primer_desorden_u64)
+	printf("=================================================================\n");
+	liberaAlineada(buf);
+}
+
+/* Mide la selección (seleccionaK) y el orden parcial (ordenaParcial) de los k menores para k = 10, 100, ... hasta 10^6 (o
+ * size) frente a ordenar el vector entero con ordena(), que da la referencia de la comprobación y de la aceleración.
+ */
+void mide_topk(int size)
+{
+	int i, k, r, error;
+	double t, minimo, mediana, p95, desviacion, completa, seleccion;
+	float *menores = reservaVector(min(size, 1000000)), x = 0;
+
+	if (menores == NULL)
+	{
+		printf("No hay memoria para la prueba de selección con %d componentes\n", size);
+		return;
+	}
+	if (formato == TEXTO)
+	{
+		printf("=================================================================\n");
+		printf("Selección y orden parcial de los k menores, %d componentes, %d hilos\n", size, omp_get_max_threads());
+	}
+	for (r = -calentamiento; r < repeticiones; r++)
+	{
+		copiarVector(vord0, vini, size);
+		t = omp_get_wtime();
+		ordena(vord0, size);
+		t = omp_get_wtime() - t;
+		if (r >= 0)
+			tiempos[r] = 1000 * t;
+	}
+	if (formato != TEXTO)
+		for (r = 0; r < repeticiones; r++)
+			escribe_fila(salida, formato, "completa", size, omp_get_max_threads(), r, tiempos[r], NAN);
+	estadisticas(tiempos, repeticiones, &minimo, &completa, &p95, &desviacion);
+	if (formato == TEXTO)
+		printf("\nOrdenación completa (ordena): mediana %0.8f milisegundos\n\n%9s %18s %12s %18s %12s\n", completa, "k",
+			   "seleccionaK (ms)", "aceleración", "ordenaParcial (ms)", "aceleración");
+
+	for (k = 10; k <= min(size, 1000000); k *= 10)
+	{
+		char nombre[32];
+
+		// seleccionaK: el componente k-1 de la ordenación, con los menores o iguales delante y los mayores o iguales detrás
+		for (r = -calentamiento; r < repeticiones; r++)
+		{
+			copiarVector(vord, vini, size);
+			t = omp_get_wtime();
+			x = seleccionaK(vord, size, k - 1);
+			t = omp_get_wtime() - t;
+			if (r >= 0)
+				tiempos[r] = 1000 * t;
+		}
+		snprintf(nombre, sizeof(nombre), "seleccionaK_%d", k);
+		if (formato != TEXTO)
+			for (r = 0; r < repeticiones; r++)
+				escribe_fila(salida, formato, nombre, size, omp_get_max_threads(), r, tiempos[r], completa);
+		estadisticas(tiempos, repeticiones, &minimo, &seleccion, &p95, &desviacion);
+		for (error = (x != vord0[k - 1]) ? k - 1 : -1, i = 0; (error < 0) && (i < size); i++)
+			if ((i < k - 1) ? (vord[i] > x) : (vord[i] < x))
+				error = i;
+		if (error >= 0)
+			fprintf((formato == TEXTO) ? stdout : stderr, "seleccionaK con k = %d no separa los menores (posición %d)\n", k, error);
+
+		// ordenaParcial: los k primeros de la ordenación completa
+		for (r = -calentamiento; r < repeticiones; r++)
+		{
+			t = omp_get_wtime();
+			error = !ordenaParcial(vini, size, k, menores);
+			t = omp_get_wtime() - t;
+			if (r >= 0)
+				tiempos[r] = 1000 * t;
+		}
+		if (error)
+		{
+			printf("No hay memoria para ordenaParcial con k = %d\n", k);
+			continue;
+		}
+		snprintf(nombre, sizeof(nombre), "ordenaParcial_%d", k);
+		if (formato != TEXTO)
+			for (r = 0; r < repeticiones; r++)
+				escribe_fila(salida, formato, nombre, size, omp_get_max_threads(), r, tiempos[r], completa);
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+		if (formato == TEXTO)
+			printf("%9d %18.6f %12.2f %18.6f %12.2f\n", k, seleccion, completa / seleccion, mediana, completa / mediana);
+		if ((error = primeraDiferencia(menores, vord0, k)) >= 0)
+			fprintf((formato == TEXTO) ? stdout : stderr, "ordenaParcial con k = %d no coincide con la ordenación (posición %d)\n", k, error);
+	}
+	if (formato == TEXTO)
+		printf("=================================================================\n");
+	liberaAlineada(menores);
+}
+
+/* Mide la inserción de lotes en un vector ordenado de size componentes (incremental.c) con lotes de size/10^4 a size
+ * componentes, frente a volver a ordenar con ordena() el vector entero con el lote añadido al final. El vector ordenado es
+ * vini ordenado y el lote, sus primeros componentes (de la misma distribución). En cada repetición se parte del mismo vector.
+ */
+void mide_lotes(int size)
+{
+	int i, b, r, error;
+	double t, minimo, mediana, p95, desviacion, reordena;
+	float *todo = reservaVector(2 * size);
+	struct vector_ordenado o;
+	char nombre[32];
+
+	if ((todo == NULL) || !creaOrdenado(&o, 2 * size))
+	{
+		printf("No hay memoria para la prueba de lotes con %d componentes\n", size);
+		liberaAlineada(todo);
+		return;
+	}
+	copiarVector(vord0, vini, size);
+	ordena(vord0, size);
+	if (formato == TEXTO)
+	{
+		printf("=================================================================\n");
+		printf("Inserción de lotes en un vector ordenado de %d componentes, %d hilos\n\n%12s %18s %18s %12s\n", size,
+			   omp_get_max_threads(), "lote", "reordenar (ms)", "insertaLote (ms)", "aceleración");
+	}
+	for (b = max(size / 10000, 1); b <= size; b = (b == size) ? size + 1 : (int)min(10L * b, (long)size))
+	{
+		// Referencia: el vector ordenado con el lote detrás, ordenado otra vez entero
+		for (r = -calentamiento; r < repeticiones; r++)
+		{
+			copiarVector(todo, vord0, size);
+			copiarVector(todo + size, vini, b);
+			t = omp_get_wtime();
+			ordena(todo, size + b);
+			t = omp_get_wtime() - t;
+			if (r >= 0)
+				tiempos[r] = 1000 * t;
+		}
+		snprintf(nombre, sizeof(nombre), "reordena_%d", b);
+		if (formato != TEXTO)
+			for (r = 0; r < repeticiones; r++)
+				escribe_fila(salida, formato, nombre, size + b, omp_get_max_threads(), r, tiempos[r], NAN);
+		estadisticas(tiempos, repeticiones, &minimo, &reordena, &p95, &desviacion);
+
+		for (error = FALSE, r = -calentamiento; r < repeticiones; r++)
+		{
+			copiarVector(o.datos, vord0, size);
+			o.n = size;
+			t = omp_get_wtime();
+			error |= !insertaLote(&o, vini, b);
+			t = omp_get_wtime() - t;
+			if (r >= 0)
+				tiempos[r] = 1000 * t;
+		}
+		if (error)
+		{
+			printf("No hay memoria para insertar un lote de %d componentes\n", b);
+			continue;
+		}
+		snprintf(nombre, sizeof(nombre), "insertaLote_%d", b);
+		if (formato != TEXTO)
+			for (r = 0; r < repeticiones; r++)
+				escribe_fila(salida, formato, nombre, size + b, omp_get_max_threads(), r, tiempos[r], reordena);
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+		if (formato == TEXTO)
+			printf("%12d %18.6f %18.6f %12.2f\n", b, reordena, mediana, reordena / mediana);
+		for (i = 0; (i < size + b) && (o.datos[i] == todo[i]); i++)
+			;
+		if ((o.n != size + b) || (i < size + b))
+			fprintf((formato == TEXTO) ? stdout : stderr, "insertaLote con un lote de %d no coincide con reordenar (posición %d)\n", b, i);
+	}
+	if (formato == TEXTO)
+		printf("=================================================================\n");
+	liberaOrdenado(&o);
+	liberaAlineada(todo);
+}
+
+// Copia de vini como "método", para medir copiarVector igual que las ordenaciones
+void copia_nativa(float vector[], int size)
+{
+	copiarVector(vector, vini, size);
+}
+
+void copia_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	copiarVector_ejecutor(e, vector, vini, size);
+}
+
+/* Mide veces seguidas, en cada repetición, el método nativo (con e NULL) o el portado al ejecutor e sobre los n primeros
+ * componentes de vini, copiados en vord con memcpy (sin abrir regiones de OpenMP que dejen hilos esperando mientras se mide
+ * el otro ejecutor). El tiempo es el de una llamada, en milisegundos. Al final vord tiene que coincidir con esperado.
+ */
+void mide_con_ejecutor(const char *nombre, metodo_ordenacion nativo, metodo_ejecutor portado, struct ejecutor *e, int n, int veces,
+					   float esperado[])
+{
+	int r, v, error;
+	double t, total, minimo, mediana, p95, desviacion;
+
+	for (r = -calentamiento; r < repeticiones; r++)
+	{
+		for (total = 0, v = 0; v < veces; v++)
+		{
+			memcpy(vord, vini, n * sizeof(float));
+			t = omp_get_wtime();
+			if (e == NULL)
+				nativo(vord, n);
+			else
+				portado(e, vord, n);
+			total += omp_get_wtime() - t;
+		}
+		if (r >= 0)
+			tiempos[r] = 1000 * total / veces;
+	}
+	if (formato != TEXTO)
+		for (r = 0; r < repeticiones; r++)
+			escribe_fila(salida, formato, nombre, n, omp_get_max_threads(), r, tiempos[r], NAN);
+	else
+	{
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+		printf("%-44s mínimo %12.6f, mediana %12.6f, p95 %12.6f ms\n", nombre, minimo, mediana, p95);
+	}
+	if ((error = primeraDiferencia(vord, esperado, n)) >= 0)
+		fprintf((formato == TEXTO) ? stdout : stderr, "%s no obtiene el resultado esperado (posición %d)\n", nombre, error);
+}
+
+/* Compara los ejecutores (ejecutor.c) con los métodos portados (los que tienen versión en un ejecutor en metodos.c) y
+ * copiarVector: cada uno con sus directivas de siempre, con el ejecutor OpenMP y con el de robo de trabajo, sobre el vector
+ * entero y en REPETIDAS_PEQUENAS ordenaciones seguidas de ORDENACION_PEQUENA componentes, donde pesa sobre todo lo que cuesta
+ * repartir y esperar. Los métodos con máximo tamaño (Dp, cuadrático) solo se miden sobre el vector entero y si no pasa de él.
+ * El de robo se mide primero en cada caso, antes de que los hilos de OpenMP se queden esperando activamente tras sus regiones.
+ */
+void mide_ejecutores(int size)
+{
+	struct ejecutor openmp, robo;
+	int i, n, veces, pequena;
+	char nombre[64];
+	const char *metodo;
+	metodo_ordenacion nativo;
+	metodo_ejecutor portado;
+	float *esperado;
+
+	creaEjecutorOpenMP(&openmp, omp_get_max_threads());
+	if (!creaEjecutorRobo(&robo, omp_get_max_threads(), TRUE))
+	{
+		printf("No se ha podido crear el ejecutor de robo de trabajo con %d hilos\n", omp_get_max_threads());
+		return;
+	}
+	copiarVector(vord0, vini, size);
+	ord_parQ(vord0, size);
+	if (formato == TEXTO)
+		printf("=================================================================\nEjecutores, %d hilos\n", omp_get_max_threads());
+	for (pequena = FALSE; pequena <= TRUE; pequena++)
+	{
+		n = pequena ? min(size, ORDENACION_PEQUENA) : size;
+		veces = pequena ? REPETIDAS_PEQUENAS : 1;
+		if (pequena)
+		{ // Referencia de las pequeñas: el principio de vini ordenado
+			memcpy(vord0, vini, n * sizeof(float));
+			ord_parQ(vord0, n);
+		}
+		if (formato == TEXTO)
+			printf("\n%d componentes, %d %s (tiempo de cada una):\n", n, veces, (veces == 1) ? "vez" : "veces seguidas");
+		for (i = 0; i <= nmetodos; i++)
+		{ // i == nmetodos: copiarVector
+			metodo = (i < nmetodos) ? metodos[i].nombre : "copiarVector";
+			nativo = (i < nmetodos) ? metodos[i].ordena : copia_nativa;
+			portado = (i < nmetodos) ? metodos[i].ejecutor : copia_ejecutor;
+			esperado = (i < nmetodos) ? vord0 : vini;
+			if ((portado == NULL) || ((i < nmetodos) && (metodos[i].max_size > 0) && (pequena || (n > metodos[i].max_size))))
+				continue;
+			snprintf(nombre, sizeof(nombre), "%s%s, robo de trabajo", metodo, pequena ? " pequeño" : "");
+			mide_con_ejecutor(nombre, nativo, portado, &robo, n, veces, esperado);
+			snprintf(nombre, sizeof(nombre), "%s%s, ejecutor OpenMP", metodo, pequena ? " pequeño" : "");
+			mide_con_ejecutor(nombre, nativo, portado, &openmp, n, veces, esperado);
+			snprintf(nombre, sizeof(nombre), "%s%s, directivas OpenMP", metodo, pequena ? " pequeño" : "");
+			mide_con_ejecutor(nombre, nativo, portado, NULL, n, veces, esperado);
+		}
+	}
+	if (formato == TEXTO)
+		printf("=================================================================\n");
+	liberaEjecutor(&robo);
+	liberaEjecutor(&openmp);
+}
+
+/* Mide la ordenación externa de un fichero de n componentes con memoria bytes: genera la entrada en $TMPDIR (por bloques,
+ * cada uno con la semilla más su n.º de bloque), la ordena en otro fichero temporal y comprueba que la salida está ordenada
+ * y tiene los mismos componentes (con la huella de compruebaFichero). El rendimiento se da en GB/s de entrada.
+ */
+void mide_externo(long n, int dist, int rango, unsigned semilla, long parametro, long memoria)
+{
+	char entrada[4096], ordenado[4096];
+	const char *dir = getenv("TMPDIR");
+	FILE *f;
+	float *b = reservaVector(BLOQUE_GENERACION);
+	long i, m, desorden;
+	int r, fd, correcto = (b != NULL);
+	uint64_t huella = 0, huella_salida;
+	uint32_t bits;
+	double t, minimo, mediana, p95, desviacion, gb = n * sizeof(float) / 1e9;
+	struct resumen_externo res;
+
+	dir = ((dir != NULL) && (*dir != '\0')) ? dir : "/tmp";
+	snprintf(entrada, sizeof(entrada), "%s/ordena_entradaXXXXXX", dir);
+	snprintf(ordenado, sizeof(ordenado), "%s/ordena_salidaXXXXXX", dir);
+	if (((fd = mkstemp(entrada)) < 0) || (close(fd) != 0) || ((fd = mkstemp(ordenado)) < 0) || (close(fd) != 0) ||
+		((f = fopen(entrada, "wb")) == NULL))
+	{
+		printf("No se pueden crear los ficheros temporales en %s\n", dir);
+		liberaAlineada(b);
+		return;
+	}
+	for (i = 0; correcto && (i < n); i += BLOQUE_GENERACION)
+	{
+		m = min(BLOQUE_GENERACION, n - i);
+		correcto = generaVector(b, (int)m, dist, rango, semilla + (unsigned)(i / BLOQUE_GENERACION), parametro);
+		for (r = 0; correcto && (r < m); r++)
+		{
+			memcpy(&bits, &b[r], sizeof(bits));
+			huella += mezcla64(bits);
+		}
+		correcto = correcto && (fwrite(b, sizeof(float), m, f) == (size_t)m);
+	}
+	correcto &= (fclose(f) == 0);
+	liberaAlineada(b);
+
+	if (formato == TEXTO)
+	{
+		printf("=================================================================\n");
+		printf("Ordenación externa de %ld componentes (%0.3f GB) con %ld MB de memoria y %d hilos\n", n, gb, memoria >> 20,
+			   omp_get_max_threads());
+	}
+	for (r = -calentamiento; correcto && (r < repeticiones); r++)
+	{
+		t = omp_get_wtime();
+		correcto = ordenaFichero(entrada, ordenado, memoria, &res);
+		t = omp_get_wtime() - t;
+		if (r >= 0)
+			tiempos[r] = 1000 * t;
+	}
+	if (!correcto)
+		printf("No se ha podido ordenar el fichero (E/S o memoria insuficiente con %ld MB)\n", memoria >> 20);
+	else
+	{
+		if (formato != TEXTO)
+			for (r = 0; r < repeticiones; r++)
+				escribe_fila(salida, formato, "externo", (int)n, omp_get_max_threads(), r, tiempos[r], NAN);
+		else
+		{
+			estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+			printf("%d tramos, %d pasadas intermedias, bloques de la mezcla de %ld componentes; última repetición: tramos %0.3f ms, "
+				   "mezcla %0.3f ms\n", res.tramos, res.pasadas, res.bloque, 1000 * res.t_tramos, 1000 * res.t_mezcla);
+			printf("\nTiempo empleado por la ordenación externa: mínimo %0.8f, mediana %0.8f, p95 %0.8f, desviación %0.8f milisegundos\n",
+				   minimo, mediana, p95, desviacion);
+			printf("Rendimiento: %0.4f GB/s (con la mediana)\n", gb / (mediana / 1000));
+		}
+		if ((desorden = compruebaFichero(ordenado, &m, &huella_salida)) != -1)
+			fprintf((formato == TEXTO) ? stdout : stderr, "El fichero ordenado no está ordenado (posición %ld)\n", desorden);
+		else if ((m != n) || (huella_salida != huella))
+			fprintf((formato == TEXTO) ? stdout : stderr, "El fichero ordenado no tiene los mismos componentes que la entrada\n");
+		else if (formato == TEXTO)
+			printf("El fichero obtenido está ordenado y tiene los mismos componentes que la entrada\n");
+	}
+	unlink(entrada);
+	unlink(ordenado);
+}
+
+
+/* Mide un método con n componentes (copia vini en vord y ordena vord en cada repetición, midiendo solo la ordenación),
+ * escribe los resultados y comprueba el vector obtenido: el primer método que se ejecuta con cada tamaño tiene que dejarlo
+ * ordenado y se guarda en vord0; los demás tienen que coincidir con vord0.
+ */
+void ejecuta_metodo(struct metodo *m, int n, int hilos)
+{
+	int r, desorden;
+	double t, minimo, mediana, p95, desviacion, ref;
+	FILE *avisos = (formato == TEXTO) ? stdout : stderr;
+
+	if ((m->max_size > 0) && (n > m->max_size))
+	{ // Los métodos cuadráticos no se miden con vectores tan grandes
+		if (formato == TEXTO)
+		{
+			printf("=================================================================\n");
+			printf("Se omite el método %s: es %s y %d componentes superan su máximo (%ld)\n", m->descripcion, m->complejidad, n, m->max_size);
+		}
+		return;
+	}
+	if (formato == TEXTO)
+	{
+		printf("=================================================================\n");
+		printf("Ordenando por el método %s\n", m->descripcion);
+		if (m->ordena == ordena)
+		{ // Sobre una copia, porque eligeMotor puede dar la vuelta al vector
+			copiarVector(vord, vini, n);
+			printf("Motor elegido: %s\n", motores[eligeMotor(vord, n)]);
+		}
+	}
+	for (r = -calentamiento; r < repeticiones; r++)
+	{
+		copiarVector(vord, vini, n); // vord <-- vini
+		if (r == 0)
+			INS_REINICIA(); // Con INSTRUMENTAR, el calentamiento no se cuenta
+		INS_MIDE(TRUE);
+		t = omp_get_wtime();
+		m->ordena(vord, n);
+		t = omp_get_wtime() - t;
+		INS_MIDE(FALSE);
+		if (r >= 0)
+			tiempos[r] = 1000 * t;
+	}
+	if (hilos == 1)
+		for (r = 0; r < repeticiones; r++)
+			anota_referencia(m->nombre, n, tiempos[r]);
+	ref = m->paralelo ? tiempo_secuencial(m, n) : NAN;
+
+	if (formato != TEXTO)
+		for (r = 0; r < repeticiones; r++)
+			escribe_fila(salida, formato, m->nombre, n, hilos, r, tiempos[r], ref);
+	else
+	{
+		estadisticas(tiempos, repeticiones, &minimo, &mediana, &p95, &desviacion);
+		printf("\nTiempo empleado por método %s: mínimo %0.8f, mediana %0.8f, p95 %0.8f, desviación %0.8f milisegundos\n",
+			   m->descripcion, minimo, mediana, p95, desviacion);
+		if (!isnan(ref))
+			printf("Aceleración: %0.4f, eficiencia: %0.4f (con la mediana)\n", ref / mediana, ref / mediana / hilos);
+	}
+	INS_INFORME(avisos, m->descripcion, repeticiones);
+
+	if (strncmp(distribucion, "ceros", 5) == 0)
+	{ // +0, -0 y NaN: cada método puede dejarlos en otro orden, pero sin perder ni duplicar ninguno
+		if (!esPermutacion(vini, vord, n))
+			fprintf(avisos, "\nEl vector obtenido por el método %s no es una permutación del inicial (n = %d, hilos = %d)\n",
+					m->descripcion, n, hilos);
+		else if (formato == TEXTO)
+			printf("\nEl vector obtenido por el método %s es una permutación del inicial\n", m->descripcion);
+	}
+	else if (referencia == NULL)
+	{
+		referencia = m;
+		copiarVector(vord0, vord, n); // vord0 <-- resultado del método de referencia
+		if ((desorden = primerDesorden(vord0, n)) >= 0)
+			fprintf(avisos, "\nEl vector obtenido por el método %s no está ordenado (n = %d, primer desorden en la posición %d: %0.4f > %0.4f)\n",
+					m->descripcion, n, desorden, vord0[desorden], vord0[desorden + 1]);
+		else if (formato == TEXTO)
+			printf("\nEl vector obtenido por el método %s está ordenado\n", m->descripcion);
+	}
+	else if (!vectoresIguales(vord0, vord, n))
+	{
+		desorden = primeraDiferencia(vord0, vord, n);
+		fprintf(avisos, "\nEl vector obtenido por el método %s no coincide con el del método %s (n = %d, hilos = %d, primera diferencia en la posición %d: %0.4f y %0.4f)\n",
+				m->descripcion, referencia->descripcion, n, hilos, desorden, vord0[desorden], vord[desorden]);
+	}
+	else if (formato == TEXTO)
+		printf("\nEl vector obtenido por el método %s coincide con el del método %s\n", m->descripcion, referencia->descripcion);
+}
+
+int main(int argc, char *argv[])
+{
+	int i, j, opcion, size = VECT_SIZE, rango = M, barrido = FALSE;
+	int seleccion[64], nsel = 0, hilos[256], nhilos = 0, tamanos[16], ntamanos = 0, ih, it, n;
+	int dist[16], ndist = 0, id;
+	long parametros[16];
+	char etiquetas[16][32];
+	unsigned semilla = SEMILLA;
+	const char *lista = NULL, *lista_dist = "uniforme", *modo = "metodos", *fichero = NULL, *entrada = NULL, *ordenado = NULL;
+	long memoria = MEMORIA_EXTERNO;
+	struct resumen_externo res;
+	double t;
+	char *copia, *nombre, *dos_puntos;
+
+	INS_ABRE(); // Antes de que OpenMP cree sus hilos, para que los contadores hardware los incluyan
+	salida = stdout;
+	while ((opcion = getopt(argc, argv, "n:m:s:d:t:r:w:k:x:u:f:o:i:e:l:bgh")) != -1)
+		switch (opcion)
+		{
+		case 'n':
+			size = atoi(optarg);
+			break;
+		case 'm':
+			rango = atoi(optarg);
+			break;
+		case 's':
+			semilla = (unsigned)strtoul(optarg, NULL, 10);
+			break;
+		case 'd':
+			lista_dist = optarg;
+			break;
+		case 't':
+			omp_set_num_threads(atoi(optarg));
+			break;
+		case 'r':
+			repeticiones = atoi(optarg);
+			break;
+		case 'w':
+			calentamiento = atoi(optarg);
+			break;
+		case 'k':
+			lista = optarg;
+			break;
+		case 'x':
+			modo = optarg;
+			break;
+		case 'u':
+			if (sscanf(optarg, "%d,%d,%d,%d,%lf", &umbrales.pequeno, &umbrales.casi, &umbrales.tramo, &umbrales.base,
+					   &umbrales.duplicados) != 5)
+			{
+				uso(argv[0]);
+				return 1;
+			}
+			break;
+		case 'f':
+			formato = (strcmp(optarg, "csv") == 0) ? CSV : (strcmp(optarg, "json") == 0) ? JSON : (strcmp(optarg, "texto") == 0) ? TEXTO : -1;
+			break;
+		case 'o':
+			fichero = optarg;
+			break;
+		case 'b':
+			barrido = TRUE;
+			break;
+		case 'g':
+			paginas_grandes = TRUE;
+			break;
+		case 'i':
+			entrada = optarg;
+			break;
+		case 'e':
+			ordenado = optarg;
+			break;
+		case 'l':
+			memoria = atol(optarg);
+			break;
+		default:
+			uso(argv[0]);
+			return (opcion == 'h') ? 0 : 1;
+		}
+	if ((size < 2) || (rango < 1) || (repeticiones < 1) || (calentamiento < 0) || (formato < 0) || (memoria < 1) ||
+		((strcmp(modo, "metodos") != 0) && (strcmp(modo, "nucleos") != 0) && (strcmp(modo, "calibra") != 0) &&
+		 (strcmp(modo, "clavevalor") != 0) && (strcmp(modo, "tipos") != 0) && (strcmp(modo, "externo") != 0) &&
+		 (strcmp(modo, "topk") != 0) && (strcmp(modo, "lotes") != 0) &&
+		 (strcmp(modo, "ejecutores") != 0)))
+	{
+		uso(argv[0]);
+		return 1;
+	}
+	if (strcmp(modo, "calibra") == 0)
+	{
+		printf("Calibrando los umbrales del método adaptativo con %d hilos y hasta %d componentes...\n", omp_get_max_threads(), size);
+		calibraUmbrales(&umbrales, size);
+		printf("-u %d,%d,%d,%d,%g\n", umbrales.pequeno, umbrales.casi, umbrales.tramo, umbrales.base, umbrales.duplicados);
+		return 0;
+	}
+	memoria <<= 20;
+	if ((strcmp(modo, "externo") == 0) && (entrada != NULL))
+	{ // De fichero a fichero
+		ordenado = (ordenado != NULL) ? ordenado : entrada;
+		t = omp_get_wtime();
+		if (!ordenaFichero(entrada, ordenado, memoria, &res))
+		{
+			printf("No se ha podido ordenar %s en %s (E/S o memoria insuficiente con %ld MB)\n", entrada, ordenado, memoria >> 20);
+			return 1;
+		}
+		t = omp_get_wtime() - t;
+		printf("%s ordenado en %s: %ld componentes, %d tramos (%d pasadas intermedias), %0.3f s (tramos %0.3f s, mezcla %0.3f s), "
+			   "%0.4f GB/s\n", entrada, ordenado, res.componentes, res.tramos, res.pasadas, t, res.t_tramos, res.t_mezcla,
+			   res.componentes * sizeof(float) / 1e9 / t);
+		return 0;
+	}
+	if ((fichero != NULL) && ((salida = fopen(fichero, "w")) == NULL))
+	{
+		printf("No se puede escribir en %s\n", fichero);
+		return 1;
+	}
+
+	// Métodos seleccionados, en el orden en que se piden
+	if (lista == NULL)
+		for (i = 0; i < nmetodos; i++)
+			seleccion[nsel++] = i;
+	else
+	{
+		copia = strdup(lista);
+		for (nombre = strtok(copia, ","); (nombre != NULL) && (nsel < 64); nombre = strtok(NULL, ","))
+		{
+			for (j = 0; (j < nmetodos) && strcmp(metodos[j].nombre, nombre); j++)
+				;
+			if (j == nmetodos)
+			{
+				printf("Método desconocido: %s\n", nombre);
+				uso(argv[0]);
+				return 1;
+			}
+			seleccion[nsel++] = j;
+		}
+		free(copia);
+	}
+
+	// Distribuciones seleccionadas, cada una con su parámetro (0 = el de por defecto)
+	copia = strdup(lista_dist);
+	for (nombre = strtok(copia, ","); (nombre != NULL) && (ndist < 16); nombre = strtok(NULL, ","))
+	{
+		snprintf(etiquetas[ndist], sizeof(etiquetas[ndist]), "%s", nombre);
+		parametros[ndist] = 0;
+		if ((dos_puntos = strchr(nombre, ':')) != NULL)
+		{
+			*dos_puntos = '\0';
+			parametros[ndist] = atol(dos_puntos + 1);
+		}
+		if ((dist[ndist] = buscaDistribucion(nombre)) < 0)
+		{
+			printf("Distribución desconocida: %s\n", nombre);
+			uso(argv[0]);
+			return 1;
+		}
+		ndist++;
+	}
+	free(copia);
+
+	if (strcmp(modo, "externo") == 0)
+	{ // Prueba de la ordenación externa con la primera distribución
+		tiempos = (double *)malloc(repeticiones * sizeof(double));
+		distribucion = etiquetas[0];
+		if (formato == CSV)
+			fprintf(salida, "metodo,distribucion,n,hilos,repeticion,tiempo_ms,elementos_por_s,aceleracion,eficiencia\n");
+		mide_externo(size, dist[0], rango, semilla, parametros[0], memoria);
+		free(tiempos);
+		if (salida != stdout)
+			fclose(salida);
+		return 0;
+	}
+
+	// Tamaños y n.º de hilos que se miden: uno de cada sin -b; con -b, potencias de 10 desde 10^3 hasta size y de 1 hilo a todos
+	if (barrido)
+	{
+		for (n = 1000; (n <= size) && (ntamanos < 16); n *= 10)
+			tamanos[ntamanos++] = n;
+		for (i = 1; (i <= omp_get_num_procs()) && (nhilos < 256); i++)
+			hilos[nhilos++] = i;
+	}
+	else
+		hilos[nhilos++] = omp_get_max_threads();
+	if (ntamanos == 0)
+		tamanos[ntamanos++] = size;
+	size = tamanos[ntamanos - 1]; // el mayor
+
+	// Reserva alineada con el primer acceso repartido entre los hilos igual que en los métodos (ver reservaAlineada)
+	vini = reservaVector(size);
+	vord0 = reservaVector(size);
+	vord = reservaVector(size);
+	tiempos = (double *)malloc(repeticiones * sizeof(double));
+	if ((vini == NULL) || (vord0 == NULL) || (vord == NULL) || (tiempos == NULL))
+	{
+		printf("No hay memoria para vectores de %d componentes\n", size);
+		return 1;
+	}
+	if (formato == CSV)
+		fprintf(salida, "metodo,distribucion,n,hilos,repeticion,tiempo_ms,elementos_por_s,aceleracion,eficiencia\n");
+
+	for (id = 0; id < ndist; id++)
+	{
+		distribucion = etiquetas[id];
+		for (it = 0; it < ntamanos; it++)
+		{
+			n = tamanos[it];
+
+			// 1. Generar el vector en el intervalo [0, rango[ con la distribución pedida (en paralelo; para una misma semilla sale
+			//	  igual con cualquier n.º de hilos)
+			if (formato == TEXTO)
+				printf("Componentes: %d, rango: [0, %d[, distribución: %s, semilla: %u, repeticiones: %d (+%d de calentamiento)\n",
+					   n, rango, distribucion, semilla, repeticiones, calentamiento);
+			if (!generaVector(vini, n, dist[id], rango, semilla, parametros[id]))
+			{
+				printf("No hay memoria para generar la distribución %s\n", distribucion);
+				return 1;
+			}
+
+			if (strcmp(modo, "nucleos") == 0)
+			{
+				mide_nucleos(n);
+				continue;
+			}
+			if (strcmp(modo, "clavevalor") == 0)
+			{
+				mide_clavevalor(n);
+				continue;
+			}
+			if (strcmp(modo, "tipos") == 0)
+			{
+				mide_tipos(n);
+				continue;
+			}
+			if (strcmp(modo, "topk") == 0)
+			{
+				mide_topk(n);
+				continue;
+			}
+			if (strcmp(modo, "lotes") == 0)
+			{
+				mide_lotes(n);
+				continue;
+			}
+			if (strcmp(modo, "ejecutores") == 0)
+			{
+				mide_ejecutores(n);
+				continue;
+			}
+
+			// 2. Imprimir vector desordenado (solo si el número de componentes no es muy grande)
+			if ((formato == TEXTO) && (n <= 400))
+			{
+				printf("\nVector antes de ser ordenado: \n");
+				printVector(vini, n);
+			}
+
+			// 3. Medir los métodos secuenciales (una sola vez por tamaño) y después los paralelos con cada n.º de hilos.
+			//	  Así la aceleración de cada método paralelo se calcula con el tiempo de su secuencial sobre el mismo vector.
+			referencia = NULL;
+			for (i = 0; i < nsel; i++)
+				if (!metodos[seleccion[i]].paralelo)
+					ejecuta_metodo(&metodos[seleccion[i]], n, 1);
+			for (ih = 0; ih < nhilos; ih++)
+			{
+				omp_set_num_threads(hilos[ih]);
+				if (formato == TEXTO)
+					printf("=================================================================\nHilos: %d\n", hilos[ih]);
+				for (i = 0; i < nsel; i++)
+					if (metodos[seleccion[i]].paralelo)
+						ejecuta_metodo(&metodos[seleccion[i]], n, hilos[ih]);
+			}
+
+			// 4. Imprimir vector ordenado (solo si el número de componentes no es muy grande)
+			if (formato == TEXTO)
+			{
+				printf("=================================================================\n");
+				if ((n <= 400) && (referencia != NULL))
+				{
+					printf("\nVector ordenado: \n");
+					printVector(vord0, n);
+				}
+				printf("\n");
+			}
+		}
+	}
+
+	if (salida != stdout)
+		fclose(salida);
+	liberaAlineada(vini);
+	liberaAlineada(vord0);
+	liberaAlineada(vord);
+	free(tiempos);
+	free(referencias);
+	return 0;
+}
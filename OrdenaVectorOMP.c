@@ -1,7 +1,6 @@
-/* Ordenación de un vector
+/* Ordenación de un vector: métodos paralelos (OpenMP) y sus núcleos (redes de ordenación, mezclas, particiones...)
  *
- * Compilación: gcc -W OrdenaVectorOMP.c -o OrdenaVectorOMP -fopenmp
- * Ejecución: ./OrdenaVectorOMP	
+ * Se compila junto con el resto de la biblioteca y el programa principal (ver Ordena.c)
 */
 
 /*
@@ -18,359 +17,2218 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
 #include <omp.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "ordena.h"
+#include "instrumentacion.h"
 
-#define M 100			// ==> Rango de valores de los componentes: [0, M[
-#define VECT_SIZE 20000 // N.º componentes del vector que se quiere ordenar
-#define NM 5			// N.º de métodos de ordenación que se llamarán desde el programa principal
-#define min(a, b) ((a) < (b) ? a : b)
-#define FALSE 0
-#define TRUE 1
+#define TRAMO_INICIAL RED_MAX // Longitud de los tramos que se ordenan con la red antes de empezar a mezclar
+#define MEZCLA_MIN 8192	// Por debajo de este n.º de componentes una mezcla no se reparte entre hilos
+#define CORTE_INSERCION RED_MAX // Las particiones de ord_parQ de este tamaño o menos se terminan con la red de ordenación
+#define CORTE_TAREA 10000 // Las particiones de ord_parQ con menos componentes no generan nuevas tareas
+#define SOBREMUESTREO 64 // Muestras que toma ord_parS por cada cubeta (hilo)
+#define LINEA_CACHE 16	// N.º de float que caben en una línea de caché de 64 bytes
+#define TRAMO_MIN RED_MAX // ord_parAn alarga los tramos naturales más cortos que esto (con inserción binaria o con la red)
+#define MIN_GALOPE 7	// Victorias seguidas de un lado tras las que la mezcla pasa a buscar por saltos (como TimSort)
 
-// Variables globales
-float vini[VECT_SIZE], vord0[VECT_SIZE], vord[VECT_SIZE]; // vector desordenado y vector que se ordenará, respectivamente
+/* Ordenación por inserción de un fragmento pequeño (se usa como caso base de los métodos mejorados) */
+void ordena_insercion(float vector[], int size)
+{
+	int i, j;
+	float x;
+	for (i = 1; i < size; i++)
+	{
+		x = vector[i];
+		j = i - 1;
+		while ((0 <= j) && (x < vector[j]))
+		{
+			vector[j + 1] = vector[j];
+			j--;
+		}
+		vector[j + 1] = x;
+	}
+}
+
+/* Mezcla secuencial de dos fragmentos ordenados, a[0..na-1] y b[0..nb-1], sobre un buffer distinto destino[0..na+nb-1].
+ * A igualdad de valores se toma primero el de a, por lo que la mezcla es estable.
+ */
+void mezcla_buffer(const float a[], int na, const float b[], int nb, float destino[])
+{
+	int i = 0, j = 0, k = 0;
+	while ((i < na) && (j < nb))
+		destino[k++] = (b[j] < a[i]) ? b[j++] : a[i++];
+	while (i < na)
+		destino[k++] = a[i++];
+	while (j < nb)
+		destino[k++] = b[j++];
+}
+
+/* Redes de ordenación bitónicas para bloques pequeños (RED_MAX componentes como mucho) y mezcla bitónica vectorizada.
+ * En x86 con AVX2 (se comprueba en tiempo de ejecución con cpuid a través de __builtin_cpu_supports) cada registro guarda
+ * 8 float y las redes comparan e intercambian registros enteros; en otro caso se usa la misma red en escalar.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define AVX2 __attribute__((target("avx2")))
+
+int hay_avx2(void)
+{
+	return __builtin_cpu_supports("avx2") != 0;
+}
+
+/* Las comparaciones de las redes no se hacen sobre los float, sino sobre una clave entera con el mismo orden: con +0/-0 o
+ * NaN, MINPS y MAXPS devuelven los dos el segundo operando, así que uno de los dos valores se duplicaría y el otro se
+ * perdería. La clave (los bits del float con los de magnitud invertidos si es negativo, como clave_float pero con signo) es
+ * la misma transformación en los dos sentidos, se aplica al cargar y al guardar cada registro y con ella min/max de enteros
+ * de 32 bits siempre devuelven una permutación: -0 va antes que +0 y cada NaN queda en un extremo según su signo.
+ */
+#define CLAVE8(v) _mm256_castsi256_ps(_mm256_xor_si256(_mm256_castps_si256(v), \
+													  _mm256_srli_epi32(_mm256_srai_epi32(_mm256_castps_si256(v), 31), 1)))
+#define MIN8(a, b) _mm256_castsi256_ps(_mm256_min_epi32(_mm256_castps_si256(a), _mm256_castps_si256(b)))
+#define MAX8(a, b) _mm256_castsi256_ps(_mm256_max_epi32(_mm256_castps_si256(a), _mm256_castps_si256(b)))
+#define CARGA8(p) CLAVE8(_mm256_loadu_ps(p))
+#define GUARDA8(p, v) _mm256_storeu_ps((p), CLAVE8(v))
+
+/* Paso de comparación-intercambio dentro de un registro: cada carril se compara con el carril permutado p y se queda con el
+ * mínimo, salvo los carriles marcados en mascara, que se quedan con el máximo */
+#define PASO8(v, p, mascara) _mm256_blend_ps(MIN8((v), (p)), MAX8((v), (p)), (mascara))
+#define PAR1(v) _mm256_permute_ps((v), 0xB1)			  // carriles (1,0,3,2,5,4,7,6)
+#define PAR2(v) _mm256_permute_ps((v), 0x4E)			  // carriles (2,3,0,1,6,7,4,5)
+#define PAR4(v) _mm256_permute2f128_ps((v), (v), 0x01) // carriles (4,5,6,7,0,1,2,3)
+
+// Ordena los 8 carriles de un registro (red bitónica de 6 pasos)
+AVX2 __m256 ordena8_avx2(__m256 v)
+{
+	v = PASO8(v, PAR1(v), 0x66);
+	v = PASO8(v, PAR2(v), 0x3C);
+	v = PASO8(v, PAR1(v), 0x5A);
+	v = PASO8(v, PAR4(v), 0xF0);
+	v = PASO8(v, PAR2(v), 0xCC);
+	return PASO8(v, PAR1(v), 0xAA);
+}
+
+// Ordena ascendentemente un registro bitónico (últimos 3 pasos de la red)
+AVX2 __m256 limpia8_avx2(__m256 v)
+{
+	v = PASO8(v, PAR4(v), 0xF0);
+	v = PASO8(v, PAR2(v), 0xCC);
+	return PASO8(v, PAR1(v), 0xAA);
+}
+
+AVX2 __m256 invierte8_avx2(__m256 v)
+{
+	return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+// Comparación-intercambio carril a carril entre dos registros: *a se queda con los menores y *b con los mayores
+AVX2 void minmax8_avx2(__m256 *a, __m256 *b)
+{
+	__m256 x = *a;
+	*a = MIN8(x, *b);
+	*b = MAX8(x, *b);
+}
+
+/* Mezcla bitónica de dos registros ordenados: al terminar *a tiene los 8 menores y *b los 8 mayores, ambos ordenados */
+AVX2 void mezcla16_avx2(__m256 *a, __m256 *b)
+{
+	__m256 r = invierte8_avx2(*b);
+	minmax8_avx2(a, &r);
+	*a = limpia8_avx2(*a);
+	*b = limpia8_avx2(r);
+}
+
+/* Ordena n = 8, 16, 32 o 64 float: cada registro se ordena por separado y después se mezclan grupos de w registros con la
+ * red bitónica (se invierte el segundo grupo para que la secuencia sea bitónica, se comparan registros a distancia
+ * w, w/2, ..., 1 y se limpia cada registro por dentro) */
+AVX2 void red_ordena_avx2(float vector[], int n)
+{
+	__m256 r[RED_MAX / 8], lo;
+	int i, g, w, d, nr = n / 8;
+	for (i = 0; i < nr; i++)
+		r[i] = ordena8_avx2(CARGA8(vector + 8 * i));
+	for (w = 1; w < nr; w *= 2)
+		for (g = 0; g < nr; g += 2 * w)
+		{
+			for (i = 0; i < w / 2; i++)
+			{
+				lo = r[g + w + i];
+				r[g + w + i] = r[g + 2 * w - 1 - i];
+				r[g + 2 * w - 1 - i] = lo;
+			}
+			for (i = 0; i < w; i++)
+				r[g + w + i] = invierte8_avx2(r[g + w + i]);
+			for (d = w; d >= 1; d /= 2)
+				for (i = g; i < g + 2 * w; i++)
+					if (((i - g) & d) == 0)
+						minmax8_avx2(&r[i], &r[i + d]);
+			for (i = g; i < g + 2 * w; i++)
+				r[i] = limpia8_avx2(r[i]);
+		}
+	for (i = 0; i < nr; i++)
+		GUARDA8(vector + 8 * i, r[i]);
+}
+
+/* Mezcla vectorizada: se mantiene en un registro los 8 mayores vistos hasta ahora y en cada paso se carga el siguiente
+ * bloque de 8 de la entrada cuya cabeza es menor; mezcla16 deja en el otro registro 8 componentes que ya son definitivos.
+ * Cuando a una de las entradas le quedan menos de 8 se termina en escalar. Al no ser estable, solo se usa con claves sueltas.
+ */
+AVX2 void mezcla_avx2(const float a[], int na, const float b[], int nb, float destino[])
+{
+	float pendiente[8], resto[16];
+	int i = 8, j = 8, k = 8, nr;
+	__m256 bajo, alto;
+
+	bajo = CARGA8(a);
+	alto = CARGA8(b);
+	mezcla16_avx2(&bajo, &alto);
+	GUARDA8(destino, bajo);
+	while ((i + 8 <= na) && (j + 8 <= nb))
+	{
+		if (a[i] <= b[j])
+		{
+			bajo = CARGA8(a + i);
+			i += 8;
+		}
+		else
+		{
+			bajo = CARGA8(b + j);
+			j += 8;
+		}
+		mezcla16_avx2(&bajo, &alto);
+		GUARDA8(destino + k, bajo);
+		k += 8;
+	}
+	// El registro pendiente se mezcla con lo que queda de la entrada casi agotada (menos de 8) y después con la otra
+	GUARDA8(pendiente, alto);
+	if (i + 8 > na)
+	{
+		mezcla_buffer(pendiente, 8, a + i, na - i, resto);
+		nr = 8 + na - i;
+		mezcla_buffer(resto, nr, b + j, nb - j, destino + k);
+	}
+	else
+	{
+		mezcla_buffer(pendiente, 8, b + j, nb - j, resto);
+		nr = 8 + nb - j;
+		mezcla_buffer(resto, nr, a + i, na - i, destino + k);
+	}
+}
+#else
+int hay_avx2(void)
+{
+	return FALSE;
+}
+#endif
+
+// Red bitónica escalar para n potencia de 2 (misma red que la versión AVX2)
+void red_ordena_escalar(float vector[], int n)
+{
+	int i, j, k, l;
+	float temp;
+	for (k = 2; k <= n; k *= 2)
+		for (j = k / 2; j > 0; j /= 2)
+			for (i = 0; i < n; i++)
+				if ((l = i ^ j) > i)
+					if ((((i & k) == 0) && (vector[i] > vector[l])) || (((i & k) != 0) && (vector[i] < vector[l])))
+					{
+						temp = vector[i];
+						vector[i] = vector[l];
+						vector[l] = temp;
+					}
+}
+
+/* Ordena un bloque de size <= RED_MAX componentes con la red de ordenación. Si size no es potencia de 2 (de 8 como mínimo)
+ * se completa con +infinito en un buffer local, que queda al final y no se copia de vuelta. Por debajo de 8 componentes
+ * la inserción es más barata que rellenar un registro.
+ */
+void ordena_red(float vector[], int size)
+{
+	float bloque[RED_MAX];
+	int i, n = 8, hay_nan = FALSE;
+	if (size < 8)
+	{
+		ordena_insercion(vector, size);
+		return;
+	}
+	while (n < size)
+		n *= 2;
+	for (i = 0; i < size; i++)
+		hay_nan |= ((bloque[i] = vector[i]) != vector[i]);
+	if (hay_nan && (n > size))
+	{ // Con NaN el relleno puede no quedar al final (la red escalar no mueve los NaN y la vectorizada los pone detrás de
+	  // +infinito) y se copiaría de vuelta un +infinito en lugar de un componente
+		ordena_insercion(vector, size);
+		return;
+	}
+	for (; i < n; i++)
+		bloque[i] = INFINITY;
+#if defined(__x86_64__) || defined(__i386__)
+	if (hay_avx2())
+		red_ordena_avx2(bloque, n);
+	else
+#endif
+		red_ordena_escalar(bloque, n);
+	for (i = 0; i < size; i++)
+		vector[i] = bloque[i];
+}
+
+// Mezcla de a y b sobre destino con el núcleo vectorizado si está disponible (mismo contrato que mezcla_buffer, salvo estabilidad)
+void mezcla_simd(const float a[], int na, const float b[], int nb, float destino[])
+{
+#if defined(__x86_64__) || defined(__i386__)
+	if ((na >= 8) && (nb >= 8) && hay_avx2())
+		mezcla_avx2(a, na, b, nb, destino);
+	else
+#endif
+		mezcla_buffer(a, na, b, nb, destino);
+}
+
+/* Co-rango (merge path): devuelve cuántos de los k primeros componentes de la mezcla de a y b proceden de a.
+ * Se busca por bisección el menor i tal que a[i] > b[k-i-1], de forma que (a[0..i-1], b[0..k-i-1]) son
+ * exactamente los k menores y se respeta el mismo criterio de desempate que mezcla_buffer.
+ */
+int co_rango(int k, const float a[], int na, const float b[], int nb)
+{
+	int i, lo = (k > nb) ? k - nb : 0, hi = min(k, na);
+	while (lo < hi)
+	{
+		i = lo + (hi - lo) / 2; // lo <= i < hi, luego i < na y k-i-1 >= 0
+		if (a[i] <= b[k - i - 1])
+			lo = i + 1;
+		else
+			hi = i;
+	}
+	return lo;
+}
+
+/* Cortes del reparto de la mezcla de a y b en partes trozos iguales de la salida: cortes[p] (p = 0..partes) es cuántos
+ * componentes de a van antes del trozo p, co_rango(p*n/partes). Con las dos entradas ordenadas co_rango ya crece con k y el
+ * ajuste no cambia nada; con NaN, que no están ordenados respecto a nada, dos bisecciones pueden cruzarse y dejar un trozo con
+ * longitud negativa en a o en b, con lo que la mezcla perdería unos componentes y duplicaría otros. Cada corte se ajusta a lo
+ * que permite el anterior, así que los trozos siempre cubren cada entrada exactamente una vez.
+ */
+void cortes_mezcla(const float a[], int na, const float b[], int nb, int partes, int cortes[])
+{
+	int p, k, i, anterior = 0, n = na + nb;
+	cortes[0] = 0;
+	for (p = 1; p <= partes; p++)
+	{
+		k = (long)p * n / partes;
+		i = co_rango(k, a, na, b, nb);
+		i = max(i, max(cortes[p - 1], k - nb));					 // ni se retrocede en a ni quedan en b más de nb...
+		cortes[p] = min(i, min(cortes[p - 1] + (k - anterior), na)); // ...ni se retrocede en b ni se pasa de na
+		anterior = k;
+	}
+}
+
+/* Mezcla de a y b sobre destino repartida entre todos los hilos.
+ * Los cortes de cada hilo en a y en b salen de cortes_mezcla (co_rango), así que los trozos son independientes (no hay
+ * dependencias entre iteraciones) y todos los hilos escriben la misma cantidad.
+ * Las mezclas pequeñas se hacen secuencialmente porque no compensa abrir una región paralela.
+ */
+void mezcla_repartida(const float a[], int na, const float b[], int nb, float destino[], nucleo_mezcla mezcla)
+{
+	int p, np = omp_get_max_threads(), n = na + nb, *cortes;
+	if ((n < MEZCLA_MIN) || (np == 1) || ((cortes = (int *)malloc((np + 1) * sizeof(int))) == NULL))
+	{
+		mezcla(a, na, b, nb, destino);
+		return;
+	}
+	cortes_mezcla(a, na, b, nb, np, cortes);
+	#pragma omp parallel for schedule(static)
+	for (p = 0; p < np; p++)
+	{
+		int k0 = (long)p * n / np, k1 = (long)(p + 1) * n / np, i0 = cortes[p], i1 = cortes[p + 1];
+		mezcla(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0), destino + k0);
+	}
+	free(cortes);
+}
+
+void mezcla_paralela(const float a[], int na, const float b[], int nb, float destino[])
+{
+	mezcla_repartida(a, na, b, nb, destino, mezcla_simd);
+}
+
+// Mezcla de mezcla_repartida_ejecutor: la parte p es la de mezcla_repartida
+struct mezcla_en_partes
+{
+	const float *a, *b;
+	float *destino;
+	int na, nb, partes, *cortes;
+	nucleo_mezcla mezcla;
+};
+
+void mezcla_parte(struct ejecutor *e, const struct tarea *t)
+{
+	struct mezcla_en_partes *m = (struct mezcla_en_partes *)t->datos;
+	long p;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+	{
+		int n = m->na + m->nb, k0 = p * n / m->partes, k1 = (p + 1) * n / m->partes, i0 = m->cortes[p], i1 = m->cortes[p + 1];
+		m->mezcla(m->a + i0, i1 - i0, m->b + (k0 - i0), (k1 - i1) - (k0 - i0), m->destino + k0);
+	}
+}
+
+// mezcla_repartida en los hilos de un ejecutor: una parte por hilo
+void mezcla_repartida_ejecutor(struct ejecutor *e, const float a[], int na, const float b[], int nb, float destino[],
+							   nucleo_mezcla mezcla)
+{
+	struct mezcla_en_partes m = {a, b, destino, na, nb, e->hilos, NULL, mezcla};
+	if ((na + nb < MEZCLA_MIN) || (m.partes == 1) || ((m.cortes = (int *)malloc((m.partes + 1) * sizeof(int))) == NULL))
+	{
+		mezcla(a, na, b, nb, destino);
+		return;
+	}
+	cortes_mezcla(a, na, b, nb, m.partes, m.cortes);
+	e->para(e, m.partes, mezcla_parte, &m);
+	free(m.cortes);
+}
+
+/* Galope: n.º de componentes de v[0..n-1] (ordenado) que van antes que x en una mezcla estable, es decir, los <= x si
+ * incluidos es TRUE o los < x si es FALSE. Busca por saltos de 1, 2, 4... desde el principio y después por bisección, así
+ * que cuesta O(log k) cuando la respuesta es k: mucho menos que comparar uno a uno cuando un lado gana muchas veces seguidas.
+ */
+int galope(float x, const float v[], int n, int incluidos)
+{
+	int lo = 0, hi = 1, med;
+	while ((hi <= n) && (incluidos ? (v[hi - 1] <= x) : (v[hi - 1] < x)))
+	{
+		lo = hi;
+		hi = 2 * hi;
+	}
+	hi = min(hi, n); // la respuesta está en [lo, hi]
+	while (lo < hi)
+	{
+		med = lo + (hi - lo) / 2;
+		if (incluidos ? (v[med] <= x) : (v[med] < x))
+			lo = med + 1;
+		else
+			hi = med;
+	}
+	return lo;
+}
+
+/* Mezcla estable con galope al estilo de TimSort: se mezcla componente a componente y, cuando un lado gana MIN_GALOPE veces
+ * seguidas, se busca con galope hasta dónde sigue ganando y ese trozo se copia de una vez con memcpy. Con tramos que apenas se
+ * entrelazan (un vector casi ordenado) la mezcla es prácticamente una copia.
+ */
+void mezcla_galope(const float a[], int na, const float b[], int nb, float destino[])
+{
+	int i = 0, j = 0, k = 0, racha_a = 0, racha_b = 0, c;
+	while ((i < na) && (j < nb))
+	{
+		if ((racha_a >= MIN_GALOPE) || (racha_b >= MIN_GALOPE))
+		{
+			c = galope(b[j], a + i, na - i, TRUE); // los de a <= b[j] van delante (estabilidad)
+			memcpy(destino + k, a + i, c * sizeof(float));
+			i += c;
+			k += c;
+			if (i == na)
+				break;
+			c = galope(a[i], b + j, nb - j, FALSE); // los de b < a[i]
+			memcpy(destino + k, b + j, c * sizeof(float));
+			j += c;
+			k += c;
+			racha_a = racha_b = 0; // se vuelve a comparar uno a uno hasta la próxima racha
+		}
+		else
+		{ // Sin saltos que dependan de los datos: con tramos al azar el predictor fallaría la mitad de las veces
+			int de_b = (b[j] < a[i]);
+			destino[k++] = de_b ? b[j] : a[i];
+			j += de_b;
+			i += 1 - de_b;
+			racha_b = de_b * (racha_b + 1);
+			racha_a = (1 - de_b) * (racha_a + 1);
+		}
+	}
+	memcpy(destino + k, a + i, (na - i) * sizeof(float));
+	memcpy(destino + k + (na - i), b + j, (nb - j) * sizeof(float));
+}
+
+/* Inserción binaria: vector[0..ordenados-1] ya está ordenado y se insertan en él los componentes siguientes hasta size,
+ * buscando la posición por bisección (detrás de los iguales, para que sea estable).
+ */
+void insercion_binaria(float vector[], int ordenados, int size)
+{
+	int i, lo, hi, med;
+	float x;
+	for (i = ordenados; i < size; i++)
+	{
+		x = vector[i];
+		for (lo = 0, hi = i; lo < hi;)
+		{
+			med = (lo + hi) / 2;
+			if (vector[med] <= x)
+				lo = med + 1;
+			else
+				hi = med;
+		}
+		for (med = i; med > lo; med--) // desplazamientos cortos (menos de TRAMO_MIN): más rápido que llamar a memmove
+			vector[med] = vector[med - 1];
+		vector[lo] = x;
+	}
+}
+
+void intercambia(float vector[], int i, int j)
+{
+	float temp = vector[i];
+	vector[i] = vector[j];
+	vector[j] = temp;
+}
+
+// Índice del valor mediano de vector[i], vector[j] y vector[k]
+int mediana3(float vector[], int i, int j, int k)
+{
+	if (vector[i] < vector[j])
+		return (vector[j] < vector[k]) ? j : ((vector[i] < vector[k]) ? k : i);
+	else
+		return (vector[i] < vector[k]) ? i : ((vector[j] < vector[k]) ? k : j);
+}
+
+/* Elección del pivote: mediana de tres para fragmentos pequeños y "ninther" de Tukey (mediana de tres medianas de tres)
+ * para los grandes, que aproxima mucho mejor la mediana real con solo 12 comparaciones.
+ */
+int elige_pivote(float vector[], int size)
+{
+	int s, m = size / 2;
+	if (size <= 40)
+		return mediana3(vector, 0, m, size - 1);
+	s = size / 8;
+	return mediana3(vector,
+					mediana3(vector, 0, s, 2 * s),
+					mediana3(vector, m - s, m, m + s),
+					mediana3(vector, size - 1 - 2 * s, size - 1 - s, size - 1));
+}
+
+/* Partición en tres vías (bandera holandesa de Dijkstra) alrededor de pivote:
+ * vector[0..*lt-1] < pivote, vector[*lt..*gt] == pivote, vector[*gt+1..size-1] > pivote.
+ * Con M = 100 y valores float hay muchos valores repetidos o casi, y la franja central no vuelve a recorrerse nunca.
+ */
+void particion3(float vector[], int size, float pivote, int *lt, int *gt)
+{
+	int i = 0, menores = 0, mayores = size - 1;
+	while (i <= mayores)
+		if (vector[i] < pivote)
+			intercambia(vector, menores++, i++);
+		else if (vector[i] > pivote)
+			intercambia(vector, i, mayores--);
+		else
+			i++;
+	*lt = menores;
+	*gt = mayores;
+}
+
+// Ordenación por montículo: se usa cuando el quicksort degenera (límite de profundidad del introsort)
+void ordena_monticulo(float vector[], int size)
+{
+	int ini, fin, raiz, hijo;
+	for (ini = size / 2 - 1, fin = size; fin > 1;)
+	{
+		if (ini >= 0)
+			raiz = ini--; // Fase de construcción del montículo
+		else
+		{ // Fase de extracción: el máximo pasa al final
+			intercambia(vector, 0, --fin);
+			raiz = 0;
+		}
+		while ((hijo = 2 * raiz + 1) < fin)
+		{
+			if ((hijo + 1 < fin) && (vector[hijo] < vector[hijo + 1]))
+				hijo++;
+			if (vector[raiz] >= vector[hijo])
+				break;
+			intercambia(vector, raiz, hijo);
+			raiz = hijo;
+		}
+	}
+}
+
+// Profundidad máxima de recursión del introsort: 2*log2(size)
+int profundidad_maxima(int size)
+{
+	int prof = 0;
+	while (size > 1)
+	{
+		size >>= 1;
+		prof += 2;
+	}
+	return prof;
+}
+
+// Introsort secuencial: se recurre sobre la parte menor y se itera sobre la mayor para acotar la pila a O(log n)
+void quicksort_intro(float vector[], int size, int prof)
+{
+	int lt, gt;
+	while (size > CORTE_INSERCION)
+	{
+		if (prof-- == 0)
+		{
+			ordena_monticulo(vector, size);
+			return;
+		}
+		particion3(vector, size, vector[elige_pivote(vector, size)], &lt, &gt);
+		if (lt < size - gt - 1)
+		{
+			quicksort_intro(vector, lt, prof);
+			vector += gt + 1;
+			size -= gt + 1;
+		}
+		else
+		{
+			quicksort_intro(vector + gt + 1, size - gt - 1, prof);
+			size = lt;
+		}
+	}
+	ordena_red(vector, size);
+}
+
+/* Introsort con tareas: tras particionar, la parte izquierda se deja como tarea para cualquier hilo libre y la derecha
+ * la sigue procesando el hilo actual. Las dos partes son disjuntas, así que no hay dependencias entre tareas.
+ */
+void quicksort_tareas(float vector[], int size, int prof)
+{
+	int lt, gt;
+	if ((size < CORTE_TAREA) || (prof == 0))
+	{
+		quicksort_intro(vector, size, prof);
+		return;
+	}
+	particion3(vector, size, vector[elige_pivote(vector, size)], &lt, &gt);
+	#pragma omp task
+	quicksort_tareas(vector, lt, prof - 1);
+	quicksort_tareas(vector + gt + 1, size - gt - 1, prof - 1);
+}
+
+/* Clave entera sin signo con el mismo orden que el float (IEEE-754): a los positivos se les activa el bit de signo y
+ * a los negativos se les invierten todos los bits, de forma que los negativos quedan delante y en orden inverso de magnitud.
+ */
+uint32_t clave_float(float x)
+{
+	uint32_t u;
+	memcpy(&u, &x, sizeof(u));
+	return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+float float_clave(uint32_t u)
+{
+	float x;
+	u = (u & 0x80000000u) ? (u & 0x7FFFFFFFu) : ~u;
+	memcpy(&x, &u, sizeof(x));
+	return x;
+}
+
+// Cubeta de x en ord_parS: n.º de separadores menores o iguales que x (búsqueda binaria)
+int cubeta(float x, const float separadores[], int nsep)
+{
+	int m, lo = 0, hi = nsep;
+	while (lo < hi)
+	{
+		m = (lo + hi) / 2;
+		if (separadores[m] <= x)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+/* Mezcla-división de dos bloques ordenados contiguos (vector[ini..med-1], vector[med..fin-1]): al terminar, el bloque de la
+ * izquierda contiene los (med-ini) menores y el de la derecha el resto, los dos ordenados. aux es un buffer del tamaño del vector
+ * del que solo se usa aux[ini..fin-1], así que parejas de bloques distintas pueden hacerlo a la vez.
+ */
+void mezcla_division(float vector[], int ini, int med, int fin, float aux[])
+{
+	INS_COMPARA(1);
+	if ((ini == med) || (med == fin) || (vector[med - 1] <= vector[med]))
+		return; // Los bloques ya están separados: no hay nada que mover
+	INS_MUEVE(2 * (fin - ini)); // la mezcla a aux y la copia de vuelta
+	mezcla_simd(vector + ini, med - ini, vector + med, fin - med, aux + ini);
+	memcpy(vector + ini, aux + ini, (fin - ini) * sizeof(float));
+}
+
+// Funciones que ordenan los size primeros elementos de un vector
+
+void ord_parA(float vector[], int size)
+{
+	int incr, i, fin2;
+	/*
+	 * Este bucle for externo no se puede paralelizar ya que todavía no están ordenados los componentes del vector ya sean en grupos que 
+	 * la variable 'incr' dicta (2,4,8...) y cuyo orden dependen de que el bucle interno, cuyas iteraciones si han sido paralelizadas, termine correctamente.
+	 * El algoritmo mezcla ordenada requiere que cada mitad de vector esté ordenada a su vez y eso implica que tenga que haber terminado la iteración previa.
+	 */
+	for (incr = 2; incr < 2 * size; incr = 2 * incr)
+	{
+		INS_INICIO(t_pasada);
+		#pragma omp parallel for schedule(static) private(fin2)
+		for (i = 0; i < (size - incr / 2); i += incr) // (i+incr/2) < size
+		{
+			INS_INICIO(t);
+			fin2 = min(size - 1, i + incr - 1);
+			mezcla_ordenada(vector, i, i + incr / 2, fin2, TRUE);
+			/* Quedan ordenados incr componentes consecutivos del vector (índices i,i+1,...i+incr-1)
+			 * (el último trozo ordenado puede ser menor: índices i, i+1,...size-1)
+			*/
+			INS_OCUPADO(t);
+		}
+		INS_PASADA(__builtin_ctz(incr) - 1, t_pasada); // pasada 0: incr = 2
+	}
+	/* El último valor de incr cumple size <= incr < 2*size. 
+		 * Esto conlleva que está ordenado todo el vector, al ser size <= incr */
+} // Fin de ord_secA
+
+/* Tramos de ancho componentes de origen mezclados de una vez en destino con mezclaK (o, si e no es NULL, con
+ * mezclaK_ejecutor). Devuelve FALSE (y origen sigue igual) si no hay memoria.
+ */
+int mezcla_tramos_k(struct ejecutor *e, const float origen[], int size, int ancho, float destino[])
+{
+	int f, ntramos = (size - 1) / ancho + 1, correcto = FALSE;
+	const float **fuentes = (const float **)malloc(ntramos * sizeof(float *));
+	long *longitudes = (long *)malloc(ntramos * sizeof(long));
+	if ((fuentes != NULL) && (longitudes != NULL))
+	{
+		for (f = 0; f < ntramos; f++)
+		{
+			fuentes[f] = origen + (long)f * ancho;
+			longitudes[f] = min(ancho, size - f * ancho);
+		}
+		correcto = (e == NULL) ? mezclaK(fuentes, longitudes, ntramos, destino)
+							   : mezclaK_ejecutor(e, fuentes, longitudes, ntramos, destino);
+	}
+	free(fuentes);
+	free(longitudes);
+	return correcto;
+}
+
+/* Cuerpo de ord_parAm y ord_parAmk. Con k_vias, en lugar de los últimos niveles (los que tienen menos parejas que hilos y
+ * reparten cada mezcla con mezcla_paralela) se mezclan todos los tramos que quedan de una vez con mezclaK: un pase por
+ * memoria en lugar de log2 del n.º de tramos.
+ */
+void mezcla_por_niveles(float vector[], int size, int k_vias)
+{
+	int ancho, p, npares, nhilos = omp_get_max_threads();
+	float *origen, *destino, *temp;
+	float *aux = reservaVector(size); // buffer de mezcla que se alterna con vector en cada nivel
+
+	if (aux == NULL)
+	{ // Sin memoria para el buffer: se ordena in situ con el método A original
+		ord_parA(vector, size);
+		return;
+	}
+
+	// Los tramos iniciales son independientes entre sí: se ordenan con la red de ordenación en paralelo
+	#pragma omp parallel for schedule(static)
+	for (p = 0; p < size; p += TRAMO_INICIAL)
+		ordena_red(vector + p, min(TRAMO_INICIAL, size - p));
+
+	/*
+	 * Igual que en ord_parA, cada nivel necesita que el anterior haya terminado, así que el bucle de niveles es secuencial.
+	 * Dentro de un nivel, las mezclas leen de origen y escriben en destino, por lo que no se solapan. Mientras haya al menos
+	 * tantas parejas de tramos como hilos se reparten las parejas; en los últimos niveles (pocas parejas muy largas) se reparte
+	 * cada mezcla entre todos los hilos con mezcla_paralela, para que no se queden hilos parados.
+	 */
+	origen = vector;
+	destino = aux;
+	for (ancho = TRAMO_INICIAL; ancho < size; ancho = 2 * ancho)
+	{
+		INS_INICIO(t_pasada);
+		npares = (size - 1) / (2 * ancho) + 1;
+		if (k_vias && (npares < nhilos) && mezcla_tramos_k(NULL, origen, size, ancho, destino))
+		{
+			INS_MUEVE(size);
+			INS_PASADA(__builtin_ctz(ancho / TRAMO_INICIAL), t_pasada);
+			temp = origen;
+			origen = destino;
+			destino = temp;
+			break;
+		}
+		if (npares >= nhilos)
+		{
+			#pragma omp parallel for schedule(static)
+			for (p = 0; p < npares; p++)
+			{
+				INS_INICIO(t);
+				int ini = 2 * ancho * p, med = min(ini + ancho, size), fin = min(ini + 2 * ancho, size);
+				mezcla_simd(origen + ini, med - ini, origen + med, fin - med, destino + ini);
+				INS_OCUPADO(t);
+			}
+		}
+		else
+			for (p = 0; p < npares; p++)
+			{
+				int ini = 2 * ancho * p, med = min(ini + ancho, size), fin = min(ini + 2 * ancho, size);
+				mezcla_paralela(origen + ini, med - ini, origen + med, fin - med, destino + ini);
+			}
+		INS_MUEVE(size); // cada nivel escribe el vector entero en destino (una vez por pasada, desde el hilo principal)
+		INS_PASADA(__builtin_ctz(ancho / TRAMO_INICIAL), t_pasada);
+		temp = origen;
+		origen = destino;
+		destino = temp;
+	}
+
+	if (origen != vector) // El último nivel ha dejado el resultado en aux
+		copiarVector(vector, origen, size);
+	liberaAlineada(aux);
+}
+
+void ord_parAm(float vector[], int size)
+{
+	mezcla_por_niveles(vector, size, FALSE);
+} // Fin de ord_parAm
+
+void ord_parAmk(float vector[], int size)
+{
+	mezcla_por_niveles(vector, size, TRUE);
+} // Fin de ord_parAmk
+
+// Nivel de ord_parAm_ejecutor: mezcla los tramos de ancho componentes de origen en destino
+struct nivel_mezcla
+{
+	float *origen, *destino;
+	int size, ancho, partes; // partes: trozos (merge path) en que se divide cada mezcla...
+	int *cortes;			 // ...y sus cortes (partes + 1 por pareja, de cortes_mezcla), si partes > 1
+};
+
+void ordena_tramos(struct ejecutor *e, const struct tarea *t)
+{
+	struct nivel_mezcla *m = (struct nivel_mezcla *)t->datos;
+	long p;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+		ordena_red(m->origen + p * TRAMO_INICIAL, min(TRAMO_INICIAL, m->size - p * TRAMO_INICIAL));
+}
+
+// Cada índice p es la parte p % partes de la pareja p / partes
+void mezcla_partes(struct ejecutor *e, const struct tarea *t)
+{
+	struct nivel_mezcla *m = (struct nivel_mezcla *)t->datos;
+	long p;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+	{
+		int par = p / m->partes, parte = p % m->partes;
+		int ini = 2 * m->ancho * par, med = min(ini + m->ancho, m->size), fin = min(ini + 2 * m->ancho, m->size);
+		int na = med - ini, nb = fin - med, n = na + nb, *cortes = m->cortes + par * (m->partes + 1);
+		int k0 = (long)parte * n / m->partes, k1 = (long)(parte + 1) * n / m->partes;
+		int i0 = (m->partes > 1) ? cortes[parte] : 0, i1 = (m->partes > 1) ? cortes[parte + 1] : na;
+		mezcla_simd(m->origen + ini + i0, i1 - i0, m->origen + med + (k0 - i0), (k1 - i1) - (k0 - i0), m->destino + ini + k0);
+	}
+}
+
+/* mezcla_por_niveles en los hilos de un ejecutor. Mismos niveles, pero cada nivel es una sola llamada a para: mientras haya
+ * al menos tantas parejas como hilos, un índice por pareja; después, cada pareja se parte en trozos con co_rango (merge path)
+ * y todos los trozos de todas las parejas van en la misma llamada, en lugar de una mezcla_paralela (una región) por pareja.
+ */
+void mezcla_por_niveles_ejecutor(struct ejecutor *e, float vector[], int size, int k_vias)
+{
+	struct nivel_mezcla m = {vector, NULL, size, TRAMO_INICIAL, 1, NULL};
+	float *temp, *aux = (float *)reservaAlineada_ejecutor(e, (long)size * sizeof(float));
+	int npares, p;
+
+	// Con partes > 1 hay menos parejas que hilos, así que npares * (partes + 1) < 3 * hilos
+	m.cortes = (int *)malloc(3 * (e->hilos + 1) * sizeof(int));
+	if ((aux == NULL) || (m.cortes == NULL))
+	{ // Sin memoria para el buffer: quicksort in situ en el mismo ejecutor
+		liberaAlineada(aux);
+		free(m.cortes);
+		ord_parQ_ejecutor(e, vector, size);
+		return;
+	}
+	e->para(e, (size + TRAMO_INICIAL - 1) / TRAMO_INICIAL, ordena_tramos, &m);
+	m.destino = aux;
+	for (; m.ancho < size; m.ancho *= 2)
+	{
+		npares = (size - 1) / (2 * m.ancho) + 1;
+		if (k_vias && (npares < e->hilos) && mezcla_tramos_k(e, m.origen, size, m.ancho, m.destino))
+		{
+			temp = m.origen;
+			m.origen = m.destino;
+			m.destino = temp;
+			break;
+		}
+		m.partes = ((npares >= e->hilos) || (2L * m.ancho < MEZCLA_MIN)) ? 1 : (e->hilos + npares - 1) / npares;
+		for (p = 0; (m.partes > 1) && (p < npares); p++)
+		{
+			int ini = 2 * m.ancho * p, med = min(ini + m.ancho, size), fin = min(ini + 2 * m.ancho, size);
+			cortes_mezcla(m.origen + ini, med - ini, m.origen + med, fin - med, m.partes, m.cortes + p * (m.partes + 1));
+		}
+		e->para(e, (long)npares * m.partes, mezcla_partes, &m);
+		temp = m.origen;
+		m.origen = m.destino;
+		m.destino = temp;
+	}
+	if (m.origen != vector)
+		copiarVector_ejecutor(e, vector, m.origen, size);
+	liberaAlineada(aux);
+	free(m.cortes);
+}
+
+void ord_parAm_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	mezcla_por_niveles_ejecutor(e, vector, size, FALSE);
+} // Fin de ord_parAm_ejecutor
+
+void ord_parAmk_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	mezcla_por_niveles_ejecutor(e, vector, size, TRUE);
+} // Fin de ord_parAmk_ejecutor
+
+/* Tramo natural que empieza en vector[ini] (sin pasar de fin): si es estrictamente decreciente se le da la vuelta (solo el
+ * estrictamente decreciente, porque invertir iguales rompería la estabilidad) y si mide menos de TRAMO_MIN se alarga hasta
+ * TRAMO_MIN. Si ya tiene al menos la mitad se alarga con inserción binaria, como TimSort; si es más corto (datos al azar en esa
+ * zona) sale más barato ordenar el bloque entero con la red de ordenación, que no depende de los datos. La red no es estable,
+ * así que +0 y -0 pueden cambiar de orden entre sí. Devuelve dónde termina el tramo.
+ */
+int tramo_natural(float vector[], int ini, int fin)
+{
+	int i = ini + 1, j, k;
+	float temp;
+	if (i == fin)
+		return fin;
+	if (vector[i] < vector[ini])
+	{
+		while ((i + 1 < fin) && (vector[i + 1] < vector[i]))
+			i++;
+		for (j = ini, k = i; j < k; j++, k--)
+		{
+			temp = vector[j];
+			vector[j] = vector[k];
+			vector[k] = temp;
+		}
+		i++;
+	}
+	else
+		while ((i < fin) && (vector[i - 1] <= vector[i]))
+			i++;
+	if (i - ini < TRAMO_MIN)
+	{
+		k = min(ini + TRAMO_MIN, fin);
+		if (2 * (i - ini) >= TRAMO_MIN)
+			insercion_binaria(vector + ini, i - ini, k - ini);
+		else
+			ordena_red(vector + ini, k - ini);
+		i = k;
+	}
+	return i;
+}
+
+void ord_parAn(float vector[], int size)
+{
+	int r, p, ntramos, nhilos = omp_get_max_threads(), maximo = size / TRAMO_MIN + nhilos + 1;
+	int *limites = (int *)malloc((maximo + 1) * sizeof(int)), *nuevos = (int *)malloc((maximo + 1) * sizeof(int));
+	int *cuantos = (int *)malloc(nhilos * sizeof(int)), *temp_limites;
+	float *origen, *destino, *temp, *aux = reservaVector(size);
+	nucleo_mezcla mezcla;
+
+	if ((limites == NULL) || (nuevos == NULL) || (cuantos == NULL) || (aux == NULL))
+	{
+		free(limites);
+		free(nuevos);
+		free(cuantos);
+		liberaAlineada(aux);
+		ord_parAm(vector, size);
+		return;
+	}
+
+	/*
+	 * 1. Cada hilo busca los tramos naturales de su trozo estático (un tramo no cruza de un trozo a otro) y guarda dónde
+	 *    terminan a partir de la posición ini/TRAMO_MIN + t de nuevos. Como todos sus tramos salvo el último miden al menos
+	 *    TRAMO_MIN, los de un hilo nunca pisan los del siguiente. Después se juntan todos en limites.
+	 */
+	#pragma omp parallel
+	{
+		int t = omp_get_thread_num(), nt = omp_get_num_threads();
+		int ini = (long)t * size / nt, fin = (long)(t + 1) * size / nt, i = ini, n = 0;
+		int *mios = nuevos + ini / TRAMO_MIN + t;
+		while (i < fin)
+			mios[n++] = i = tramo_natural(vector, i, fin);
+		cuantos[t] = n;
+		#pragma omp barrier
+		#pragma omp single
+		{
+			int h, k;
+			ntramos = 0;
+			limites[0] = 0;
+			for (h = 0; h < nt; h++)
+				for (k = 0; k < cuantos[h]; k++)
+					limites[++ntramos] = nuevos[(long)h * size / nt / TRAMO_MIN + h + k];
+		}
+	}
+
+	/*
+	 * 2. Árbol de mezclas equilibrado: en cada nivel se mezcla cada pareja de tramos vecinos (de origen a destino, como en
+	 *    ord_parAm) y el n.º de tramos se divide por 2, así que hay log2(ntramos) niveles. Un vector casi ordenado tiene pocos
+	 *    tramos y mezclas que son casi copias, por lo que se ordena en tiempo casi lineal. Las parejas pequeñas se reparten
+	 *    entre los hilos (con planificación dinámica, porque los tramos naturales miden cosas muy distintas) y las que
+	 *    ocupan más de lo que corresponde a un hilo se mezclan después, una a una, entre todos con mezcla_repartida.
+	 */
+	origen = vector;
+	destino = aux;
+	// Si casi todos los tramos han salido de la red (datos al azar), el galope no va a encontrar rachas: mezcla vectorizada
+	mezcla = (ntramos > size / (2 * TRAMO_MIN)) ? mezcla_simd : mezcla_galope;
+	while (ntramos > 1)
+	{
+		int npares = (ntramos + 1) / 2, grande = size / nhilos;
+
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (p = 0; p < npares; p++)
+		{
+			int ini = limites[2 * p], med = limites[min(2 * p + 1, ntramos)], fin = limites[min(2 * p + 2, ntramos)];
+			if ((fin - ini <= grande) || (nhilos == 1))
+				mezcla(origen + ini, med - ini, origen + med, fin - med, destino + ini);
+		}
+		for (p = 0; p < npares; p++)
+		{
+			int ini = limites[2 * p], med = limites[min(2 * p + 1, ntramos)], fin = limites[min(2 * p + 2, ntramos)];
+			if ((fin - ini > grande) && (nhilos > 1))
+				mezcla_repartida(origen + ini, med - ini, origen + med, fin - med, destino + ini, mezcla);
+		}
+
+		for (r = 0; r <= npares; r++)
+			nuevos[r] = limites[min(2 * r, ntramos)];
+		temp_limites = limites;
+		limites = nuevos;
+		nuevos = temp_limites;
+		ntramos = npares;
+		temp = origen;
+		origen = destino;
+		destino = temp;
+	}
+
+	if (origen != vector)
+		copiarVector(vector, origen, size);
+	free(limites);
+	free(nuevos);
+	free(cuantos);
+	liberaAlineada(aux);
+} // Fin de ord_parAn
+
+// Estado de ord_parAn_ejecutor: en la búsqueda cada índice es un trozo y en cada nivel una pareja de tramos
+struct tramos_naturales
+{
+	float *vector, *origen, *destino;
+	int size, nt, ntramos, grande;
+	int *limites, *nuevos, *cuantos;
+	nucleo_mezcla mezcla;
+};
+
+void busca_tramos(struct ejecutor *e, const struct tarea *t)
+{
+	struct tramos_naturales *m = (struct tramos_naturales *)t->datos;
+	long q;
+	(void)e;
+	for (q = t->ini; q < t->fin; q++)
+	{
+		int ini = q * m->size / m->nt, fin = (q + 1) * m->size / m->nt, i = ini, n = 0;
+		int *mios = m->nuevos + ini / TRAMO_MIN + q;
+		while (i < fin)
+			mios[n++] = i = tramo_natural(m->vector, i, fin);
+		m->cuantos[q] = n;
+	}
+}
+
+void mezcla_parejas(struct ejecutor *e, const struct tarea *t)
+{
+	struct tramos_naturales *m = (struct tramos_naturales *)t->datos;
+	long p;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+	{
+		int ini = m->limites[2 * p], med = m->limites[min(2 * p + 1, m->ntramos)], fin = m->limites[min(2 * p + 2, m->ntramos)];
+		if ((fin - ini <= m->grande) || (m->nt == 1))
+			m->mezcla(m->origen + ini, med - ini, m->origen + med, fin - med, m->destino + ini);
+	}
+}
+
+/* ord_parAn en los hilos de un ejecutor: los mismos dos pasos, con un trozo por hilo en la búsqueda de tramos, una llamada a
+ * para con las parejas pequeñas de cada nivel y una mezcla_repartida_ejecutor por cada pareja grande.
+ */
+void ord_parAn_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	struct tramos_naturales m = {vector, vector, NULL, size, e->hilos, 0, 0, NULL, NULL, NULL, NULL};
+	int r, p, h, k, maximo = size / TRAMO_MIN + m.nt + 1, *temp_limites;
+	float *temp, *aux = (float *)reservaAlineada_ejecutor(e, (long)size * sizeof(float));
+
+	m.limites = (int *)malloc((maximo + 1) * sizeof(int));
+	m.nuevos = (int *)malloc((maximo + 1) * sizeof(int));
+	m.cuantos = (int *)malloc(m.nt * sizeof(int));
+	if ((m.limites == NULL) || (m.nuevos == NULL) || (m.cuantos == NULL) || (aux == NULL))
+	{
+		free(m.limites);
+		free(m.nuevos);
+		free(m.cuantos);
+		liberaAlineada(aux);
+		ord_parAm_ejecutor(e, vector, size);
+		return;
+	}
+
+	e->para(e, m.nt, busca_tramos, &m);
+	m.limites[0] = 0;
+	for (h = 0; h < m.nt; h++)
+		for (k = 0; k < m.cuantos[h]; k++)
+			m.limites[++m.ntramos] = m.nuevos[(long)h * size / m.nt / TRAMO_MIN + h + k];
+
+	m.destino = aux;
+	m.mezcla = (m.ntramos > size / (2 * TRAMO_MIN)) ? mezcla_simd : mezcla_galope;
+	m.grande = size / m.nt;
+	while (m.ntramos > 1)
+	{
+		int npares = (m.ntramos + 1) / 2;
+
+		e->para(e, npares, mezcla_parejas, &m);
+		for (p = 0; p < npares; p++)
+		{
+			int ini = m.limites[2 * p], med = m.limites[min(2 * p + 1, m.ntramos)], fin = m.limites[min(2 * p + 2, m.ntramos)];
+			if ((fin - ini > m.grande) && (m.nt > 1))
+				mezcla_repartida_ejecutor(e, m.origen + ini, med - ini, m.origen + med, fin - med, m.destino + ini, m.mezcla);
+		}
+
+		for (r = 0; r <= npares; r++)
+			m.nuevos[r] = m.limites[min(2 * r, m.ntramos)];
+		temp_limites = m.limites;
+		m.limites = m.nuevos;
+		m.nuevos = temp_limites;
+		m.ntramos = npares;
+		temp = m.origen;
+		m.origen = m.destino;
+		m.destino = temp;
+	}
+
+	if (m.origen != vector)
+		copiarVector_ejecutor(e, vector, m.origen, size);
+	free(m.limites);
+	free(m.nuevos);
+	free(m.cuantos);
+	liberaAlineada(aux);
+} // Fin de ord_parAn_ejecutor
+
+void ord_parB(float vector[], int size)
+{
+	int i, j;
+	float x;
+	/* 
+	 * Este bucle for no se puede paralelizar porque requiere que las anteriores posiciones con respecto a i estén ordenadas. Nos basamos en un bucle en 
+	 * el cual cada iteración utiliza x posiciones de vector, + 1 posición añadida en cada iteración. Si lanzamos 8 hilos por ejemplo, al ejecutar dicho bucle 
+	 * trabajaran en comun en un mismo vector desordenado y en el que probablemente aparecerán inconsistencias.
+	 * En nuestra opinión, este algoritmo debe desarrollarse de manera necesariamente secuencial.
+	 * 
+	 * (R=read; W=write)
+	 * Para i=1 
+	 * R = vector[1] 
+	 * R = vector[0]
+	 * W = vector[1]
+	 * W = vector[2]
+	 * 
+	 * Para i=2
+	 * R = vector[2] 
+	 * R = vector[1]
+	 * W = vector[2]
+	 * W = vector[3]
+	 * 
+	 * Como vemos en este esquema simple se produce una dependencia RAW entre la iteración i=j e i=j+1 ya que en la iteración i=j, dentro del bucle while la primera iteración
+	 * escribiría en el vector[j+1], que en el caso de la siguiente iteracion (i=j+1) leerá dicha posición del vector al hacer "x=vector[j+1]". Por esta dependencia loop-carried
+	 * este bucle no es paralelizable con dicha implementación.
+	 */
+	for (int i = 1; i < size; i++)
+	{
+		x = vector[i];
+		j = i - 1;
+		while ((0 <= j) && (x < vector[j])) // Se comprueba j antes de leer vector[j] (vector[-1] queda fuera del vector)
+		{
+			vector[j + 1] = vector[j];
+			j--;
+		}
+		vector[j + 1] = x;
+	}
+} // Fin de ord_secB
+
+void ord_parC(float vector[], int size)
+{
+	int list_length, i;
+	float temp;
+	
+	/* 
+	 * Cada iteración tiene por objetivo encontrar el número mayor, y dejarlo apartado en la última posición del vector de tamaño N para esa iteración i=j; para que, 
+	 * de esta forma, en la siguiente iteración (i=j+1), con un vector de tamaño N-1, ya no se contemple ese número grande. Por esa razón, una iteración debe haberse completado 
+	 * y haber retirado su número más grande del campo de visión del vector de la iteración posterior, antes de que esta comience. Si no fuese así, y una iteración posterior comenzase 
+	 * antes de que la anterior previa hubiese terminado, podría ocurrir que, ambas iteraciones escojan el mismo número más grande, y el algoritmo, por tanto no cumpla su cometido. 
+	 * Como curiosidad, la complejidad temporal de este algoritmo viene acotada por O(n^2) porque hay n iteraciones y posiciones, y por cada una, se recorre (n-i) posiciones.
+	 */
+	for (list_length = size; list_length >= 2; list_length--)
+		/* 
+		* El siguiente for no se puede paralelizar ya que, por ejemplo, en la iteración i=0 
+		* puede que haya que escribir en vector[1] y en la iteración siguiente (i=1) hay que leer vector[1].
+		* Así pues, si se cumple la condición del "if" hay una dependencia leer después de escribir (RAW)
+		* entre la iteración 0 y la 1.
+		* [ En general, hay una dependencia RAW entre cualquier iteración, i=k,
+		* (que no sea la última) y la siguiente respecto al operando vector[k+1], si se cumple la condición
+		* del "if", cosa que puede ocurrir o no dependiendo de los datos de entrada).] 	
+		*/
+		for (i = 0; i < list_length - 1; i++)
+			if (vector[i] > vector[i + 1])
+			{
+				temp = vector[i];
+				vector[i] = vector[i + 1];
+				vector[i + 1] = temp;
+			}
+
+} // Fin de ord_secC
+
+void ord_parD(float vector[], int size)
+{
+	int phase, i;
+	float temp;
+
+	/*
+	 * El siguiente for no se puede paralelizar ya que entre una fase y la siguiente hay dependencias RAW:
+     * por ejemplo, un fase puede escribir en vector[1] y la siguiente lee vector[1]
+	 */
+	/*
+	 * Cada fase es una región con un for nowait: la barrera implícita del final de la región es la misma que la del parallel for.
+	 * Con INSTRUMENTAR cada hilo mide lo que trabaja y lo que espera en esa barrera (INS_BARRERA_FINAL), que sin
+	 * instrumentar no genera nada.
+	 */
+	for (phase = 0; phase < size; phase++)
+	{
+		INS_INICIO(t_region);
+		if (phase % 2 == 0)
+		{ // Fase par
+			#pragma omp parallel private(temp)
+			{
+				INS_INICIO(t);
+				#pragma omp for nowait
+				for (i = 1; i < size; i += 2)
+				{
+					INS_COMPARA(1);
+					if (vector[i - 1] > vector[i])
+					{
+						temp = vector[i];
+						vector[i] = vector[i - 1];
+						vector[i - 1] = temp;
+						INS_MUEVE(2);
+					}
+				}
+				INS_OCUPADO(t);
+				INS_BARRERA_FINAL();
+			}
+		}
+		else
+		{ // Fase impar
+			#pragma omp parallel private(temp)
+			{
+				INS_INICIO(t);
+				#pragma omp for nowait
+				for (i = 1; i < size - 1; i += 2)
+				{
+					INS_COMPARA(1);
+					if (vector[i] > vector[i + 1])
+					{
+						temp = vector[i];
+						vector[i] = vector[i + 1];
+						vector[i + 1] = temp;
+						INS_MUEVE(2);
+					}
+				}
+				INS_OCUPADO(t);
+				INS_BARRERA_FINAL();
+			}
+		}
+		INS_REGION(t_region);
+	}
+} // Fin de ord_parD
+
+void ord_parDm(float vector[], int size)
+{
+	int phase, i;
+	float temp;
+
+	/*
+	 * El siguiente for no se puede paralelizar ya que entre una fase y la siguiente hay dependencias RAW:
+     * por ejemplo, un fase puede escribir en vector[1] y la siguiente lee vector[1]
+	 */
+	for (phase = 0; phase < size; phase++)
+	{ // Misma región con for nowait que en ord_parD
+		INS_INICIO(t_region);
+		#pragma omp parallel private(temp)
+		{
+			INS_INICIO(t);
+			#pragma omp for nowait
+			for (i = 1; i < size - (phase % 2); i += 2)
+			{
+				INS_COMPARA(1);
+				if (vector[i - 1 + (phase % 2)] > vector[i + (phase % 2)])
+				{
+					temp = vector[i];
+					vector[i] = vector[i - 1 + 2 * (phase % 2)];
+					vector[i - 1 + 2 * (phase % 2)] = temp;
+					INS_MUEVE(2);
+				}
+			}
+			INS_OCUPADO(t);
+			INS_BARRERA_FINAL();
+		}
+		INS_REGION(t_region);
+	}
+} // Fin de ord_parDm
+
+void ord_parQ(float vector[], int size)
+{
+	/*
+	 * Un único hilo lanza la recursión y el resto de hilos del equipo van ejecutando las tareas que se generan.
+	 * La barrera implícita al final de la región paralela espera a que terminen todas las tareas.
+	 */
+	#pragma omp parallel
+	#pragma omp single
+	quicksort_tareas(vector, size, profundidad_maxima(size));
+} // Fin de ord_parQ
+
+// quicksort_tareas como tarea de un ejecutor: datos es el vector, [ini, fin[ el trozo y nivel la profundidad que le queda
+void quicksort_ejecutor(struct ejecutor *e, const struct tarea *t)
+{
+	float *vector = (float *)t->datos;
+	struct tarea izquierda = *t;
+	long ini = t->ini, fin = t->fin;
+	int lt, gt, prof = t->nivel;
+	while ((fin - ini >= CORTE_TAREA) && (prof > 0))
+	{ // La parte izquierda queda como tarea y este hilo sigue con la derecha
+		particion3(vector + ini, fin - ini, vector[ini + elige_pivote(vector + ini, fin - ini)], &lt, &gt);
+		izquierda.ini = ini;
+		izquierda.fin = ini + lt;
+		izquierda.nivel = --prof;
+		e->lanza(e, &izquierda);
+		ini += gt + 1;
+	}
+	quicksort_intro(vector + ini, fin - ini, prof);
+}
+
+// ord_parQ en los hilos de un ejecutor (ver ejecutor.c)
+void ord_parQ_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	struct tarea raiz = {quicksort_ejecutor, vector, 0, size, profundidad_maxima(size), NULL};
+	e->ejecuta(e, &raiz);
+} // Fin de ord_parQ_ejecutor
+
+/*
+ * Pasadas de la ordenación por base (LSD), RADIX_BITS bits por pasada, desde el byte menos significativo de la clave. Las
+ * claves se reparten en nt trozos estáticos y cada trozo es siempre del mismo hilo (o de la misma tarea del ejecutor):
+ *  1. Cada trozo cuenta cuántas de sus claves caen en cada cubeta (histograma propio, sin sincronización).
+ *  2. Un hilo convierte las cuentas en posiciones de salida con una suma prefija que recorre cubeta a cubeta y, dentro
+ *     de cada cubeta, trozo a trozo. Así cada trozo sabe en qué posiciones exactas escribe cada cubeta.
+ *  3. Cada trozo se reparte (con sus valores) en el buffer de destino. Las posiciones no se solapan y el orden relativo
+ *     se mantiene (la ordenación es estable, que es lo que necesita LSD).
+ * Si todas las claves caen en la misma cubeta (sumando las cuentas de todos los trozos) la pasada no cambia nada y se omite:
+ * pasa con los bytes que comparten todas las claves, como el alto cuando todos los valores están en [1, 2[.
+ * en_aux dice si las claves de la pasada están en aux (y vaux) o en datos (y valores).
+ */
+void cuenta_trozo_base(struct ordenacion_base *o, int en_aux, int desp, int t, int nt)
+{
+	int i, b, ini = (long)t * o->size / nt, fin = (long)(t + 1) * o->size / nt, *mias = o->cuenta + t * RADIX_CUBETAS;
+	const uint32_t *origen = (const uint32_t *)(en_aux ? o->aux : o->datos);
+	const uint64_t *origen64 = (const uint64_t *)(en_aux ? o->aux : o->datos);
+
+	for (b = 0; b < RADIX_CUBETAS; b++)
+		mias[b] = 0;
+	if (o->ancho == 8)
+		for (i = ini; i < fin; i++)
+			mias[(origen64[i] >> desp) & (RADIX_CUBETAS - 1)]++;
+	else
+		for (i = ini; i < fin; i++)
+			mias[(origen[i] >> desp) & (RADIX_CUBETAS - 1)]++;
+}
+
+// Suma prefija de las cuentas de los nt trozos. Devuelve TRUE si hay que omitir la pasada
+int suma_base(struct ordenacion_base *o, int nt)
+{
+	int b, h, c, suma = 0, omitir = FALSE;
+	for (b = 0; b < RADIX_CUBETAS; b++)
+	{
+		for (c = 0, h = 0; h < nt; h++)
+			c += o->cuenta[h * RADIX_CUBETAS + b];
+		if (c == o->size)
+			omitir = TRUE; // La cubeta tiene las claves de todos los trozos
+		for (h = 0; h < nt; h++)
+		{
+			c = o->cuenta[h * RADIX_CUBETAS + b];
+			o->cuenta[h * RADIX_CUBETAS + b] = suma;
+			suma += c;
+		}
+	}
+	return omitir;
+}
+
+void reparte_trozo_base(struct ordenacion_base *o, int en_aux, int desp, int t, int nt)
+{
+	int i, ini = (long)t * o->size / nt, fin = (long)(t + 1) * o->size / nt, *mias = o->cuenta + t * RADIX_CUBETAS;
+	const uint32_t *origen = (const uint32_t *)(en_aux ? o->aux : o->datos), *vo = en_aux ? o->vaux : o->valores;
+	uint32_t *destino = (uint32_t *)(en_aux ? o->datos : o->aux), *vd = en_aux ? o->valores : o->vaux;
+	const uint64_t *origen64 = (const uint64_t *)origen;
+	uint64_t *destino64 = (uint64_t *)destino;
+
+	if (o->ancho == 8)
+		for (i = ini; i < fin; i++)
+			destino64[mias[(origen64[i] >> desp) & (RADIX_CUBETAS - 1)]++] = origen64[i];
+	else if (vo == NULL)
+		for (i = ini; i < fin; i++)
+			destino[mias[(origen[i] >> desp) & (RADIX_CUBETAS - 1)]++] = origen[i];
+	else
+		for (i = ini; i < fin; i++)
+		{
+			int pos = mias[(origen[i] >> desp) & (RADIX_CUBETAS - 1)]++;
+			destino[pos] = origen[i];
+			vd[pos] = vo[i];
+		}
+}
+
+/* Las pasadas en una región paralela: la llaman todos los hilos a la vez y el trozo de cada uno es el de su n.º de hilo.
+ * Cada hilo tiene que haber escrito antes las claves de su trozo, [t*size/nt, (t+1)*size/nt). Devuelve TRUE si el resultado
+ * ha quedado en aux (y vaux) y FALSE si en datos (y valores); como cada pasada termina con una barrera, a la vuelta cada hilo
+ * puede leer su trozo del resultado.
+ */
+int pasadas_base(struct ordenacion_base *o)
+{
+	int desp, t = omp_get_thread_num(), nt = omp_get_num_threads(), en_aux = FALSE, primero = (o->ancho == 8) ? 32 : 0;
+
+	for (desp = primero; desp < primero + 32; desp += RADIX_BITS)
+	{
+		cuenta_trozo_base(o, en_aux, desp, t, nt);
+		#pragma omp barrier
+		#pragma omp single
+		o->omitir = suma_base(o, nt);
+		// Barrera implícita: todos ven las posiciones calculadas
+		if (!o->omitir)
+		{
+			reparte_trozo_base(o, en_aux, desp, t, nt);
+			en_aux = !en_aux;
+		}
+		#pragma omp barrier // La pasada siguiente lee lo que han escrito los demás hilos (y la siguiente single reescribe omitir)
+	}
+	return en_aux;
+}
+
+// Pasada de pasadas_base_ejecutor: cada índice es un trozo
+struct pasada_base
+{
+	struct ordenacion_base *o;
+	int en_aux, desp, nt;
+};
+
+void cuenta_base(struct ejecutor *e, const struct tarea *t)
+{
+	struct pasada_base *p = (struct pasada_base *)t->datos;
+	long q;
+	(void)e;
+	for (q = t->ini; q < t->fin; q++)
+		cuenta_trozo_base(p->o, p->en_aux, p->desp, q, p->nt);
+}
+
+void reparte_base(struct ejecutor *e, const struct tarea *t)
+{
+	struct pasada_base *p = (struct pasada_base *)t->datos;
+	long q;
+	(void)e;
+	for (q = t->ini; q < t->fin; q++)
+		reparte_trozo_base(p->o, p->en_aux, p->desp, q, p->nt);
+}
+
+/* Las pasadas en los hilos de un ejecutor, con un trozo por hilo (o->cuenta tiene sitio para e->hilos histogramas): cada
+ * paso es una llamada a para y la suma prefija la hace el hilo que llama. Devuelve lo mismo que pasadas_base.
+ */
+int pasadas_base_ejecutor(struct ejecutor *e, struct ordenacion_base *o)
+{
+	struct pasada_base p = {o, FALSE, 0, e->hilos};
+	int primero = (o->ancho == 8) ? 32 : 0;
+
+	for (p.desp = primero; p.desp < primero + 32; p.desp += RADIX_BITS)
+	{
+		e->para(e, p.nt, cuenta_base, &p);
+		if (!suma_base(o, p.nt))
+		{
+			e->para(e, p.nt, reparte_base, &p);
+			p.en_aux = !p.en_aux;
+		}
+	}
+	return p.en_aux;
+}
+
+void ord_parR(float vector[], int size)
+{
+	int nhilos = omp_get_max_threads();
+	uint32_t *claves = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t)), *aux = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+	int *cuenta = (int *)malloc(nhilos * RADIX_CUBETAS * sizeof(int)); // cuenta[hilo][cubeta]
+	struct ordenacion_base o = {claves, aux, NULL, NULL, size, 4, cuenta, FALSE};
+
+	if ((claves == NULL) || (aux == NULL) || (cuenta == NULL))
+	{ // Sin memoria para los buffers: se ordena con el quicksort, que trabaja in situ
+		liberaAlineada(claves);
+		liberaAlineada(aux);
+		free(cuenta);
+		ord_parQ(vector, size);
+		return;
+	}
+
+	// Ordenación por base (pasadas_base) sobre las claves enteras de los float, todo en una sola región paralela
+	#pragma omp parallel
+	{
+		int i, t = omp_get_thread_num(), nt = omp_get_num_threads();
+		int ini = (long)t * size / nt, fin = (long)(t + 1) * size / nt;
+		uint32_t *resultado;
+
+		for (i = ini; i < fin; i++)
+			claves[i] = clave_float(vector[i]);
+		resultado = pasadas_base(&o) ? aux : claves;
+		for (i = ini; i < fin; i++)
+			vector[i] = float_clave(resultado[i]);
+	}
+
+	liberaAlineada(claves);
+	liberaAlineada(aux);
+	free(cuenta);
+} // Fin de ord_parR
+
+// Conversión de ord_parR_ejecutor entre los float y sus claves enteras
+struct claves_float
+{
+	float *vector;
+	uint32_t *claves;
+};
+
+void a_claves(struct ejecutor *e, const struct tarea *t)
+{
+	struct claves_float *c = (struct claves_float *)t->datos;
+	long i;
+	(void)e;
+	for (i = t->ini; i < t->fin; i++)
+		c->claves[i] = clave_float(c->vector[i]);
+}
+
+void de_claves(struct ejecutor *e, const struct tarea *t)
+{
+	struct claves_float *c = (struct claves_float *)t->datos;
+	long i;
+	(void)e;
+	for (i = t->ini; i < t->fin; i++)
+		c->vector[i] = float_clave(c->claves[i]);
+}
+
+// ord_parR en los hilos de un ejecutor (pasadas_base_ejecutor)
+void ord_parR_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	uint32_t *claves = (uint32_t *)reservaAlineada_ejecutor(e, (long)size * sizeof(uint32_t));
+	uint32_t *aux = (uint32_t *)reservaAlineada_ejecutor(e, (long)size * sizeof(uint32_t));
+	int *cuenta = (int *)malloc(e->hilos * RADIX_CUBETAS * sizeof(int));
+	struct ordenacion_base o = {claves, aux, NULL, NULL, size, 4, cuenta, FALSE};
+	struct claves_float c = {vector, claves};
+
+	if ((claves == NULL) || (aux == NULL) || (cuenta == NULL))
+	{
+		liberaAlineada(claves);
+		liberaAlineada(aux);
+		free(cuenta);
+		ord_parQ_ejecutor(e, vector, size);
+		return;
+	}
+	e->para(e, size, a_claves, &c);
+	if (pasadas_base_ejecutor(e, &o))
+		c.claves = aux;
+	e->para(e, size, de_claves, &c);
+
+	liberaAlineada(claves);
+	liberaAlineada(aux);
+	free(cuenta);
+} // Fin de ord_parR_ejecutor
+
+/* Separadores de ord_parS: se toman ncubetas*SOBREMUESTREO posiciones pseudoaleatorias (dispersión multiplicativa del índice,
+ * sin estado compartido), se ordenan y se eligen ncubetas-1 separadores equiespaciados. Con el sobremuestreo las cubetas salen
+ * equilibradas con alta probabilidad aunque la entrada tenga estructura (ordenada, inversa...). Los separadores se dejan al
+ * principio de muestras (ncubetas*SOBREMUESTREO componentes), que es lo que devuelve.
+ */
+float *elige_separadores(const float vector[], int size, float muestras[], int ncubetas)
+{
+	int i, b, nmuestras = ncubetas * SOBREMUESTREO;
+	for (i = 0; i < nmuestras; i++)
+		muestras[i] = vector[(uint32_t)(((uint64_t)(i + 1) * 2654435761u) % (uint32_t)size)];
+	quicksort_intro(muestras, nmuestras, profundidad_maxima(nmuestras));
+	for (b = 0; b < ncubetas - 1; b++) // separadores[b] = muestras[(b+1)*SOBREMUESTREO]
+		muestras[b] = muestras[(b + 1) * SOBREMUESTREO];
+	return muestras;
+}
+
+// Suma prefija de cuenta[trozo][cubeta] (n trozos y n cubetas), cubeta a cubeta y, dentro de cada una, trozo a trozo
+void posiciones_cubetas(int cuenta[], int n)
+{
+	int b, q, c, suma = 0;
+	for (b = 0; b < n; b++)
+		for (q = 0; q < n; q++)
+		{
+			c = cuenta[q * n + b];
+			cuenta[q * n + b] = suma;
+			suma += c;
+		}
+}
+
+void ord_parS(float vector[], int size)
+{
+	int i, b, p, nhilos = omp_get_max_threads(), nmuestras = nhilos * SOBREMUESTREO;
+	float *muestras, *separadores, *aux;
+	int *cuenta;
+
+	if ((nhilos == 1) || (size < nmuestras * 16))
+	{ // Con un hilo o con vectores pequeños el muestreo no compensa
+		ord_parQ(vector, size);
+		return;
+	}
+	muestras = (float *)malloc(nmuestras * sizeof(float));
+	aux = reservaVector(size);
+	cuenta = (int *)malloc(nhilos * nhilos * sizeof(int)); // cuenta[trozo][cubeta]
+	if ((muestras == NULL) || (aux == NULL) || (cuenta == NULL))
+	{
+		free(muestras);
+		liberaAlineada(aux);
+		free(cuenta);
+		ord_parQ(vector, size);
+		return;
+	}
+
+	// 1. Sobremuestreo (elige_separadores)
+	separadores = elige_separadores(vector, size, muestras, nhilos);
+
+	/*
+	 * 2. Un único intercambio: cada hilo clasifica su trozo estático, una suma prefija (cubeta a cubeta y, dentro de cada
+	 *    una, trozo a trozo) da la posición de cada trozo dentro de cada cubeta, y cada hilo reparte sus componentes en aux.
+	 * 3. Las cubetas son disjuntas y están ordenadas entre sí, así que cada hilo ordena la suya por separado (introsort
+	 *    secuencial) y la devuelve a vector, sin más sincronización. Se usa schedule(dynamic) porque las cubetas no tienen
+	 *    exactamente el mismo tamaño.
+	 */
+	#pragma omp parallel private(i, b)
+	{
+		#pragma omp for schedule(static)
+		for (p = 0; p < nhilos; p++)
+		{
+			int ini = (long)p * size / nhilos, fin = (long)(p + 1) * size / nhilos, *mias = cuenta + p * nhilos;
+			for (b = 0; b < nhilos; b++)
+				mias[b] = 0;
+			for (i = ini; i < fin; i++)
+				mias[cubeta(vector[i], separadores, nhilos - 1)]++;
+		}
+
+		#pragma omp single
+		posiciones_cubetas(cuenta, nhilos);
+
+		#pragma omp for schedule(static)
+		for (p = 0; p < nhilos; p++)
+		{
+			int ini = (long)p * size / nhilos, fin = (long)(p + 1) * size / nhilos, *mias = cuenta + p * nhilos;
+			for (i = ini; i < fin; i++)
+				aux[mias[cubeta(vector[i], separadores, nhilos - 1)]++] = vector[i];
+		}
+
+		/* Tras el reparto, cuenta[q][b] apunta al final de lo que escribió el trozo q en la cubeta b: la cubeta b empieza
+		 * donde termina lo del último trozo en la cubeta b-1 y termina donde termina lo del último trozo en la cubeta b */
+		#pragma omp for schedule(dynamic, 1)
+		for (b = 0; b < nhilos; b++)
+		{
+			int ini = (b == 0) ? 0 : cuenta[(nhilos - 1) * nhilos + b - 1], fin = cuenta[(nhilos - 1) * nhilos + b];
+			quicksort_intro(aux + ini, fin - ini, profundidad_maxima(fin - ini));
+			memcpy(vector + ini, aux + ini, (fin - ini) * sizeof(float));
+		}
+	}
+
+	free(muestras);
+	liberaAlineada(aux);
+	free(cuenta);
+} // Fin de ord_parS
 
-void copiarVector(float Vdest[], float V[], int size)
+// Estado de ord_parS_ejecutor: un trozo y una cubeta por hilo
+struct muestreo
 {
-	int i;
-	#pragma omp parallel for schedule(dynamic)
-	for (i = 0; i < size; ++i)
-		Vdest[i] = V[i];
+	float *vector, *aux, *separadores;
+	int size, n;
+	int *cuenta; // cuenta[trozo][cubeta]
+};
+
+void clasifica_trozos(struct ejecutor *e, const struct tarea *t)
+{
+	struct muestreo *m = (struct muestreo *)t->datos;
+	long p;
+	int i, b;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+	{
+		int ini = p * m->size / m->n, fin = (p + 1) * m->size / m->n, *mias = m->cuenta + p * m->n;
+		for (b = 0; b < m->n; b++)
+			mias[b] = 0;
+		for (i = ini; i < fin; i++)
+			mias[cubeta(m->vector[i], m->separadores, m->n - 1)]++;
+	}
 }
 
-void printVector(float vector[], int size)
+void reparte_trozos(struct ejecutor *e, const struct tarea *t)
 {
-	/* 
-   * Este bucle for no se puede paralelizar porque al distribuir las distintas iteraciones entre los distintos hilos
-   * pueden existir hilos que tarden menos que otros y en consecuencia algunas iteraciones se impriman antes que otras
-   * alterando el orden original de vector.
-   */
-	for (int i = 0; i < size; ++i)
-		printf("%0.4f\t", vector[i]);
-	printf("\n\n");
-}
-
-int estaOrdenado(float vector[], int size)
-{
-	/* Comenzamos a paralelizar el bucle y para ello la primera transformación que hicimos fue pasar de un bucle do-while,
-	 * a un bucle for cuya condición era la que este bucle while tiene. Nos dimos cuenta que OpenMP no permitía este tipo de condiciones
-	 * al desconocer el numero de iteraciones que realiza. Entonces convertimo el bucle en uno cuya cabecera era for(i=1; i<size; i++) y con
-	 * if nos permitía saber si el orden del vector era creciente y en ese caso continuar o por el contrario salirnos con la sentencia "break".
-	 * Lo que nos llevó a una segunda apreciación y es que dicha llamada no está permitida al manejar varios hilos de ejecución.
-	 * La CONCLUSIÓN FINAL fue que llegamos a la conclusión de que este bucle no es paralelizable.
-	 */
-	int i = 0;
-	do
-		i++;
-	while ((vector[i - 1] <= vector[i]) && (i < size - 1));
+	struct muestreo *m = (struct muestreo *)t->datos;
+	long p;
+	int i;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+	{
+		int ini = p * m->size / m->n, fin = (p + 1) * m->size / m->n, *mias = m->cuenta + p * m->n;
+		for (i = ini; i < fin; i++)
+			m->aux[mias[cubeta(m->vector[i], m->separadores, m->n - 1)]++] = m->vector[i];
+	}
+}
 
-	return ((i == size - 1) && (vector[i - 1] <= vector[i])); // TRUE (1) si el vector está ordenado y FALSE (0) en caso contrario
+void ordena_cubetas(struct ejecutor *e, const struct tarea *t)
+{
+	struct muestreo *m = (struct muestreo *)t->datos;
+	long b;
+	(void)e;
+	for (b = t->ini; b < t->fin; b++)
+	{
+		int ini = (b == 0) ? 0 : m->cuenta[(m->n - 1) * m->n + b - 1], fin = m->cuenta[(m->n - 1) * m->n + b];
+		quicksort_intro(m->aux + ini, fin - ini, profundidad_maxima(fin - ini));
+		memcpy(m->vector + ini, m->aux + ini, (fin - ini) * sizeof(float));
+	}
 }
 
-int vectoresIguales(float vecta[], float vectb[], int size)
+// ord_parS en los hilos de un ejecutor: cada paso de la región de ord_parS es una llamada a para
+void ord_parS_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	struct muestreo m = {vector, NULL, NULL, size, e->hilos, NULL};
+	float *muestras;
+
+	if ((m.n == 1) || (size < m.n * SOBREMUESTREO * 16))
+	{
+		ord_parQ_ejecutor(e, vector, size);
+		return;
+	}
+	muestras = (float *)malloc(m.n * SOBREMUESTREO * sizeof(float));
+	m.aux = (float *)reservaAlineada_ejecutor(e, (long)size * sizeof(float));
+	m.cuenta = (int *)malloc(m.n * m.n * sizeof(int));
+	if ((muestras == NULL) || (m.aux == NULL) || (m.cuenta == NULL))
+	{
+		free(muestras);
+		liberaAlineada(m.aux);
+		free(m.cuenta);
+		ord_parQ_ejecutor(e, vector, size);
+		return;
+	}
+	m.separadores = elige_separadores(vector, size, muestras, m.n);
+	e->para(e, m.n, clasifica_trozos, &m);
+	posiciones_cubetas(m.cuenta, m.n);
+	e->para(e, m.n, reparte_trozos, &m);
+	e->para(e, m.n, ordena_cubetas, &m);
+
+	free(muestras);
+	liberaAlineada(m.aux);
+	free(m.cuenta);
+} // Fin de ord_parS_ejecutor
+
+void ord_parDp(float vector[], int size)
 {
-	int i, ini, fin, iguales = TRUE, np = omp_get_num_procs(); // número de núcleos del microprocesador
-	#pragma omp parallel for schedule(dynamic) private(ini, fin)
-	for (i = 0; i < np; i++)
+	int hay_cambios[3] = {FALSE, FALSE, FALSE};
+
+	/*
+	 * Misma ordenación par-impar que ord_parD, pero con una sola región paralela alrededor del bucle de fases en lugar
+	 * de abrir una en cada una de las size fases. Cada hilo se queda durante toda la ordenación con el mismo trozo
+	 * [ini, fin[, cuyos límites se redondean a múltiplos de LINEA_CACHE para que dos hilos no escriban en la misma
+	 * línea de caché. Como los límites son pares, en la fase par cada pareja cae entera dentro de un trozo, y en la impar
+	 * la última pareja de un trozo toca solo el primer componente del siguiente, que ese hilo no usa en esa fase.
+	 *
+	 * Parada temprana: cada hilo apunta si ha intercambiado algo en la pareja de fases (par + impar) y el indicador
+	 * compartido es el OR de todos (reducción hecha a mano sobre hay_cambios, porque la región no termina en cada
+	 * iteración). Si en una fase par y la impar siguiente no ha cambiado nada, el vector ya está ordenado.
+	 * Se rotan tres indicadores: el de la iteración actual se lee tras la barrera, y el hilo 0 limpia el de la
+	 * siguiente, que nadie puede estar leyendo todavía (su última lectura fue hace dos iteraciones). La lectura no tiene que
+	 * ser atómica: tras la barrera ya nadie escribe en el indicador de la iteración actual.
+	 */
+	INS_INICIO(t_region);
+	#pragma omp parallel
 	{
-		ini = i * size / np;
-		fin = (i + 1) * size / np;
-		int j = ini;
-		while ((vecta[j] == vectb[j]) && (j < fin))
-			j++;
+		int i, it, cambio, t = omp_get_thread_num(), nt = omp_get_num_threads();
+		int ini = (int)(((long)t * size / nt) & ~(long)(LINEA_CACHE - 1));
+		int fin = (t == nt - 1) ? size : (int)(((long)(t + 1) * size / nt) & ~(long)(LINEA_CACHE - 1));
+		float temp;
 
-		#pragma omp critical
+		for (it = 0; 2 * it < size; it++)
 		{
-			iguales = iguales && (j == fin);
+			INS_INICIO(t_par);
+			cambio = FALSE;
+			// Fase par: parejas (i, i+1) con i par
+			for (i = ini; (i < fin) && (i + 1 < size); i += 2)
+			{
+				INS_COMPARA(1);
+				if (vector[i] > vector[i + 1])
+				{
+					temp = vector[i];
+					vector[i] = vector[i + 1];
+					vector[i + 1] = temp;
+					cambio = TRUE;
+					INS_MUEVE(2);
+				}
+			}
+			INS_OCUPADO(t_par);
+			INS_BARRERA();
+			INS_INICIO(t_impar);
+			// Fase impar: parejas (i, i+1) con i impar
+			for (i = ini + 1; (i < fin) && (i + 1 < size); i += 2)
+			{
+				INS_COMPARA(1);
+				if (vector[i] > vector[i + 1])
+				{
+					temp = vector[i];
+					vector[i] = vector[i + 1];
+					vector[i + 1] = temp;
+					cambio = TRUE;
+					INS_MUEVE(2);
+				}
+			}
+			if (cambio)
+			{
+				#pragma omp atomic write
+				hay_cambios[it % 3] = TRUE;
+			}
+			INS_OCUPADO(t_impar);
+			INS_BARRERA();
+			if (t == 0)
+			{
+				#pragma omp atomic write
+				hay_cambios[(it + 1) % 3] = FALSE;
+			}
+			if (!hay_cambios[it % 3])
+				break; // Todos los hilos leen el mismo valor, así que salen todos en la misma iteración
 		}
 	}
-	return iguales;
-}
+	INS_REGION(t_region);
+} // Fin de ord_parDp
 
-/* Función que mezcla dos fragmentos ordenados contiguos de un vector en un solo fragmento ordenado
- * Fragmentos ordenados de entrada: (vector[ini1]... vector[ini2-1]),		(vector[ini2]... vector[fin2])
- * Fragmento ordenado que contiene el resultado:	(vector[ini1]... vector[ini2-1], vector[ini2]... vector[fin2]) 
-*/
-void mezcla_ordenada(float vector[], int ini1, int ini2, int fin2)
+// Fase de ord_parDp_ejecutor: cada índice es un trozo, con los mismos límites que en ord_parDp
+struct par_impar
+{
+	float *vector;
+	int size, nt, fase; // fase: 0 la par, 1 la impar
+	int cambio;			// lo pone a TRUE el trozo que intercambia algo
+};
+
+void fase_trozos(struct ejecutor *e, const struct tarea *t)
 {
-	int i, j, k, terminado = 0;
+	struct par_impar *d = (struct par_impar *)t->datos;
+	long q;
+	int i, cambio = FALSE;
 	float temp;
-	i = ini1;
-	j = ini2;
-	do
-	{													// vector[ini1] <=...<= vector[j-1] AND vector[j] <=...<= vector[fin2] AND i < j
-		while ((vector[i] <= vector[j]) && (i < j - 1)) // 2a condicion para que no adelante i a j (solo se produce al final)
-			i++;
-		if (vector[i] > vector[j])
-		{
-			/* Rotamos vector[i], vector[i+1], ...,vector[j-1], vector[j]
-					 * para que vector[j] pase a la posición i y el resto se desplace una posición a la derecha */
-			temp = vector[j];
-			#pragma omp parallel for schedule(dynamic)
-			for (k = j; k > i; k--)
-				vector[k] = vector[k - 1];
-			vector[i] = temp;
-			if (j == fin2)
-				terminado = 1;
-			// Hemos colocado en su posición el último elemento del segundo fragmento
-			else
+	(void)e;
+	for (q = t->ini; q < t->fin; q++)
+	{
+		int ini = (int)((q * d->size / d->nt) & ~(long)(LINEA_CACHE - 1));
+		int fin = (q == d->nt - 1) ? d->size : (int)(((q + 1) * d->size / d->nt) & ~(long)(LINEA_CACHE - 1));
+		for (i = ini + d->fase; (i < fin) && (i + 1 < d->size); i += 2)
+			if (d->vector[i] > d->vector[i + 1])
 			{
-				j++;
-				i++;
+				temp = d->vector[i];
+				d->vector[i] = d->vector[i + 1];
+				d->vector[i + 1] = temp;
+				cambio = TRUE;
 			}
-		}
-		// vector[ini1] <=...<= vector[j-1] AND vector[j] <=...<= vector[fin2] AND i < j
-		else
-			terminado = 1;
-		/* i == j-1 AND vector[i] <= vector[j], 
-				 * luego vector[j-1] <= vector[j] y todo queda ordenado*/
-	} while (!terminado);
+	}
+	if (cambio)
+		__atomic_store_n(&d->cambio, TRUE, __ATOMIC_RELAXED);
 }
 
-// Funciones que ordenan los size primeros elementos de un vector
+/* ord_parDp en los hilos de un ejecutor. Un ejecutor no tiene barreras dentro de un bucle, así que cada fase es una llamada
+ * a para (lo que en ord_parD es abrir una región), pero con los trozos de ord_parDp y su parada temprana: como la llamada
+ * termina cuando terminan todos los trozos, basta con un indicador, que se limpia antes de cada pareja de fases.
+ */
+void ord_parDp_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	struct par_impar d = {vector, size, e->hilos, 0, TRUE};
+	int it;
 
-void ord_parA(float vector[], int size)
+	for (it = 0; (2 * it < size) && d.cambio; it++)
+	{
+		d.cambio = FALSE;
+		for (d.fase = 0; d.fase < 2; d.fase++)
+			e->para(e, d.nt, fase_trozos, &d);
+	}
+} // Fin de ord_parDp_ejecutor
+
+void ord_parDb(float vector[], int size)
 {
-	int incr, i, fin2;
+	int nbloques = omp_get_max_threads(), tam = (size + nbloques - 1) / nbloques; // tamaño de bloque
+	float *aux = reservaVector(size);
+
+	if (aux == NULL)
+	{
+		ord_parDp(vector, size);
+		return;
+	}
+
 	/*
-	 * Este bucle for externo no se puede paralelizar ya que todavía no están ordenados los componentes del vector ya sean en grupos que 
-	 * la variable 'incr' dicta (2,4,8...) y cuyo orden dependen de que el bucle interno, cuyas iteraciones si han sido paralelizadas, termine correctamente.
-	 * El algoritmo mezcla ordenada requiere que cada mitad de vector esté ordenada a su vez y eso implica que tenga que haber terminado la iteración previa.
+	 * Ordenación par-impar por bloques: el vector se divide en un bloque por hilo, cada hilo ordena el suyo con el introsort
+	 * secuencial y después se hacen nbloques fases par-impar en las que cada pareja de bloques vecinos hace una mezcla-división
+	 * (los menores se quedan en el bloque izquierdo y los mayores en el derecho). Es el mismo esquema que ord_parD cambiando
+	 * componentes por bloques, así que en lugar de size barreras hay nbloques. En cada fase las parejas son disjuntas.
+	 * Las nbloques fases solo bastan si todos los bloques tienen el mismo tamaño: por eso todos miden tam y solo el último
+	 * (o los últimos, que pueden quedar vacíos) es más corto, lo que equivale a rellenarlo con +infinito, que no se mueve de ahí.
 	 */
-	for (incr = 2; incr < 2 * size; incr = 2 * incr)
-		#pragma omp parallel for schedule(static) private(fin2)
-		for (i = 0; i < (size - incr / 2); i += incr) // (i+incr/2) < size
+	INS_INICIO(t_region);
+	#pragma omp parallel
+	{
+		int b, fase;
+
+		INS_INICIO(t_local);
+		#pragma omp for schedule(static) nowait
+		for (b = 0; b < nbloques; b++)
 		{
-			fin2 = min(size - 1, i + incr - 1);
-			mezcla_ordenada(vector, i, i + incr / 2, fin2);
-			/* Quedan ordenados incr componentes consecutivos del vector (índices i,i+1,...i+incr-1)
-			 * (el último trozo ordenado puede ser menor: índices i, i+1,...size-1)
-			*/
+			int ini = min((long)b * tam, size), fin = min((long)(b + 1) * tam, size);
+			quicksort_intro(vector + ini, fin - ini, profundidad_maxima(fin - ini));
 		}
-	/* El último valor de incr cumple size <= incr < 2*size. 
-		 * Esto conlleva que está ordenado todo el vector, al ser size <= incr */
-} // Fin de ord_secA
+		INS_OCUPADO(t_local);
+		INS_BARRERA(); // la barrera implícita del for, medida con INSTRUMENTAR
 
-void ord_parB(float vector[], int size)
+		for (fase = 0; fase < nbloques; fase++)
+		{
+			INS_INICIO(t_fase);
+			#pragma omp for schedule(static) nowait
+			for (b = fase % 2; b < nbloques - 1; b += 2)
+				mezcla_division(vector, min((long)b * tam, size), min((long)(b + 1) * tam, size),
+								min((long)(b + 2) * tam, size), aux);
+			INS_OCUPADO(t_fase);
+			INS_BARRERA();
+		}
+	}
+	INS_REGION(t_region);
+
+	liberaAlineada(aux);
+} // Fin de ord_parDb
+
+// Bloques de ord_parDb_ejecutor y ord_parDbk_ejecutor, todos de tam componentes salvo los últimos
+struct bloques
 {
-	int i, j;
-	float x;
-	/* 
-	 * Este bucle for no se puede paralelizar porque requiere que las anteriores posiciones con respecto a i estén ordenadas. Nos basamos en un bucle en 
-	 * el cual cada iteración utiliza x posiciones de vector, + 1 posición añadida en cada iteración. Si lanzamos 8 hilos por ejemplo, al ejecutar dicho bucle 
-	 * trabajaran en comun en un mismo vector desordenado y en el que probablemente aparecerán inconsistencias.
-	 * En nuestra opinión, este algoritmo debe desarrollarse de manera necesariamente secuencial.
-	 * 
-	 * (R=read; W=write)
-	 * Para i=1 
-	 * R = vector[1] 
-	 * R = vector[0]
-	 * W = vector[1]
-	 * W = vector[2]
-	 * 
-	 * Para i=2
-	 * R = vector[2] 
-	 * R = vector[1]
-	 * W = vector[2]
-	 * W = vector[3]
-	 * 
-	 * Como vemos en este esquema simple se produce una dependencia RAW entre la iteración i=j e i=j+1 ya que en la iteración i=j, dentro del bucle while la primera iteración
-	 * escribiría en el vector[j+1], que en el caso de la siguiente iteracion (i=j+1) leerá dicha posición del vector al hacer "x=vector[j+1]". Por esta dependencia loop-carried
-	 * este bucle no es paralelizable con dicha implementación.
-	 */
-	for (int i = 1; i < size; i++)
+	float *vector, *aux;
+	int size, tam, fase;
+	const float **fuentes; // ord_parDbk_ejecutor: dónde empieza cada bloque...
+	long *longitudes;	   // ...y cuánto mide (NULL en ord_parDb_ejecutor)
+};
+
+void ordena_bloques(struct ejecutor *e, const struct tarea *t)
+{
+	struct bloques *m = (struct bloques *)t->datos;
+	long b;
+	(void)e;
+	for (b = t->ini; b < t->fin; b++)
 	{
-		x = vector[i];
-		j = i - 1;
-		while ((x < vector[j]) && (0 <= j))
+		int ini = min(b * m->tam, (long)m->size), fin = min((b + 1) * m->tam, (long)m->size);
+		quicksort_intro(m->vector + ini, fin - ini, profundidad_maxima(fin - ini));
+		if (m->fuentes != NULL)
 		{
-			vector[j + 1] = vector[j];
-			j--;
+			m->fuentes[b] = m->vector + ini;
+			m->longitudes[b] = fin - ini;
 		}
-		vector[j + 1] = x;
 	}
-} // Fin de ord_secB
+}
 
-void ord_parC(float vector[], int size)
+// Cada índice p es la pareja de bloques (b, b+1) con b = 2p + fase % 2
+void divide_parejas(struct ejecutor *e, const struct tarea *t)
 {
-	int list_length, i;
-	float temp;
-	
-	/* 
-	 * Cada iteración tiene por objetivo encontrar el número mayor, y dejarlo apartado en la última posición del vector de tamaño N para esa iteración i=j; para que, 
-	 * de esta forma, en la siguiente iteración (i=j+1), con un vector de tamaño N-1, ya no se contemple ese número grande. Por esa razón, una iteración debe haberse completado 
-	 * y haber retirado su número más grande del campo de visión del vector de la iteración posterior, antes de que esta comience. Si no fuese así, y una iteración posterior comenzase 
-	 * antes de que la anterior previa hubiese terminado, podría ocurrir que, ambas iteraciones escojan el mismo número más grande, y el algoritmo, por tanto no cumpla su cometido. 
-	 * Como curiosidad, la complejidad temporal de este algoritmo viene acotada por O(n^2) porque hay n iteraciones y posiciones, y por cada una, se recorre (n-i) posiciones.
-	 */
-	for (list_length = size; list_length >= 2; list_length--)
-		/* 
-		* El siguiente for no se puede paralelizar ya que, por ejemplo, en la iteración i=0 
-		* puede que haya que escribir en vector[1] y en la iteración siguiente (i=1) hay que leer vector[1].
-		* Así pues, si se cumple la condición del "if" hay una dependencia leer después de escribir (RAW)
-		* entre la iteración 0 y la 1.
-		* [ En general, hay una dependencia RAW entre cualquier iteración, i=k,
-		* (que no sea la última) y la siguiente respecto al operando vector[k+1], si se cumple la condición
-		* del "if", cosa que puede ocurrir o no dependiendo de los datos de entrada).] 	
-		*/
-		for (i = 0; i < list_length - 1; i++)
-			if (vector[i] > vector[i + 1])
-			{
-				temp = vector[i];
-				vector[i] = vector[i + 1];
-				vector[i + 1] = temp;
-			}
+	struct bloques *m = (struct bloques *)t->datos;
+	long p, b;
+	(void)e;
+	for (p = t->ini; p < t->fin; p++)
+	{
+		b = 2 * p + m->fase % 2;
+		mezcla_division(m->vector, min(b * m->tam, (long)m->size), min((b + 1) * m->tam, (long)m->size),
+						min((b + 2) * m->tam, (long)m->size), m->aux);
+	}
+}
 
-} // Fin de ord_secC
+// ord_parDb en los hilos de un ejecutor: un bloque por hilo y una llamada a para por fase
+void ord_parDb_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	int nbloques = e->hilos;
+	struct bloques m = {vector, NULL, size, (size + nbloques - 1) / nbloques, 0, NULL, NULL};
 
-void ord_parD(float vector[], int size)
+	m.aux = (float *)reservaAlineada_ejecutor(e, (long)size * sizeof(float));
+	if (m.aux == NULL)
+	{
+		ord_parDp_ejecutor(e, vector, size);
+		return;
+	}
+	e->para(e, nbloques, ordena_bloques, &m);
+	for (m.fase = 0; m.fase < nbloques; m.fase++)
+		e->para(e, (nbloques - m.fase % 2) / 2, divide_parejas, &m);
+	liberaAlineada(m.aux);
+} // Fin de ord_parDb_ejecutor
+
+void ord_parDbk(float vector[], int size)
 {
-	int phase, i;
-	float temp;
+	int b, nbloques = omp_get_max_threads(), tam = (size + nbloques - 1) / nbloques;
+	float *aux = reservaVector(size);
+	const float **fuentes = (const float **)malloc(nbloques * sizeof(float *));
+	long *longitudes = (long *)malloc(nbloques * sizeof(long));
 
 	/*
-	 * El siguiente for no se puede paralelizar ya que entre una fase y la siguiente hay dependencias RAW:
-     * por ejemplo, un fase puede escribir en vector[1] y la siguiente lee vector[1]
+	 * Los bloques se ordenan igual que en ord_parDb, pero en lugar de las nbloques fases par-impar de mezcla-división (nbloques
+	 * pases por el vector) se mezclan todos de una vez con mezclaK, que reparte la salida entre los hilos a partes iguales
+	 * (selección en varias secuencias), y el resultado se devuelve a vector: dos pases, con cualquier n.º de hilos.
 	 */
-	for (phase = 0; phase < size; phase++)
-		if (phase % 2 == 0)
-		{ // Fase par
-			#pragma omp parallel for private(temp)
-			for (i = 1; i < size; i += 2)
-				if (vector[i - 1] > vector[i])
-				{
-					temp = vector[i];
-					vector[i] = vector[i - 1];
-					vector[i - 1] = temp;
-				}
-		}
-		else
-		{ // Fase impar
-			#pragma omp parallel for private(temp)
-			for (i = 1; i < size - 1; i += 2)
-				if (vector[i] > vector[i + 1])
-				{
-					temp = vector[i];
-					vector[i] = vector[i + 1];
-					vector[i + 1] = temp;
-				}
-		}
-} // Fin de ord_parD
+	if ((aux == NULL) || (fuentes == NULL) || (longitudes == NULL))
+	{
+		liberaAlineada(aux);
+		free(fuentes);
+		free(longitudes);
+		ord_parDb(vector, size);
+		return;
+	}
+	#pragma omp parallel for schedule(static)
+	for (b = 0; b < nbloques; b++)
+	{
+		int ini = min((long)b * tam, size), fin = min((long)(b + 1) * tam, size);
+		quicksort_intro(vector + ini, fin - ini, profundidad_maxima(fin - ini));
+		fuentes[b] = vector + ini;
+		longitudes[b] = fin - ini;
+	}
+	if (mezclaK(fuentes, longitudes, nbloques, aux))
+		copiarVector(vector, aux, size);
+	else
+		ord_parDb(vector, size); // Sin memoria para los torneos: los bloques ya están ordenados y Db solo tiene que mezclarlos
 
-void ord_parDm(float vector[], int size)
+	liberaAlineada(aux);
+	free(fuentes);
+	free(longitudes);
+} // Fin de ord_parDbk
+
+// ord_parDbk en los hilos de un ejecutor: los bloques de ord_parDb_ejecutor mezclados con mezclaK_ejecutor
+void ord_parDbk_ejecutor(struct ejecutor *e, float vector[], int size)
 {
-	int phase, i;
-	float temp;
+	int nbloques = e->hilos;
+	struct bloques m = {vector, NULL, size, (size + nbloques - 1) / nbloques, 0, NULL, NULL};
+
+	m.aux = (float *)reservaAlineada_ejecutor(e, (long)size * sizeof(float));
+	m.fuentes = (const float **)malloc(nbloques * sizeof(float *));
+	m.longitudes = (long *)malloc(nbloques * sizeof(long));
+	if ((m.aux == NULL) || (m.fuentes == NULL) || (m.longitudes == NULL))
+	{
+		liberaAlineada(m.aux);
+		free(m.fuentes);
+		free(m.longitudes);
+		ord_parDb_ejecutor(e, vector, size);
+		return;
+	}
+	e->para(e, nbloques, ordena_bloques, &m);
+	if (mezclaK_ejecutor(e, m.fuentes, m.longitudes, nbloques, m.aux))
+		copiarVector_ejecutor(e, vector, m.aux, size);
+	else
+		ord_parDb_ejecutor(e, vector, size);
+
+	liberaAlineada(m.aux);
+	free(m.fuentes);
+	free(m.longitudes);
+} // Fin de ord_parDbk_ejecutor
+
+void ord_parSk(float vector[], int size)
+{
+	int nhilos = omp_get_max_threads(), nmuestras = nhilos * SOBREMUESTREO, correcto = TRUE;
+	float *aux, *muestras;
+	const float **fuentes;
+	long *cortes, *limites;
+
+	if ((nhilos == 1) || (size < nmuestras * 16))
+	{ // Como en ord_parS
+		ord_parQ(vector, size);
+		return;
+	}
+	aux = reservaVector(size);
+	muestras = (float *)malloc(nmuestras * sizeof(float));
+	fuentes = (const float **)malloc(nhilos * sizeof(float *));
+	cortes = (long *)malloc((long)nhilos * (nhilos + 1) * sizeof(long)); // cortes[trozo][cubeta]: donde empieza la cubeta
+	limites = (long *)malloc(2L * nhilos * nhilos * sizeof(long)); // inicio y fin en cada trozo de la cubeta de cada hilo
+	if ((aux == NULL) || (muestras == NULL) || (fuentes == NULL) || (cortes == NULL) || (limites == NULL))
+	{
+		liberaAlineada(aux);
+		free(muestras);
+		free(fuentes);
+		free(cortes);
+		free(limites);
+		ord_parS(vector, size);
+		return;
+	}
 
 	/*
-	 * El siguiente for no se puede paralelizar ya que entre una fase y la siguiente hay dependencias RAW:
-     * por ejemplo, un fase puede escribir en vector[1] y la siguiente lee vector[1]
+	 * Ordenación por muestreo regular (PSRS): al revés que ord_parS, primero cada hilo ordena su trozo estático y después se
+	 * reparte. Las muestras se toman a intervalos regulares de los trozos ya ordenados (SOBREMUESTREO por trozo), así que los
+	 * separadores dejan en cada cubeta como mucho unos 2*size/nhilos componentes sin necesitar muestras al azar. El trozo de
+	 * cada cubeta en cada trozo se busca por bisección (galope) y cada hilo mezcla los nhilos trozos de su cubeta con un
+	 * torneo (mezcla_k) en su sitio de aux: una mezcla de k vías en lugar de ordenar la cubeta desde cero. Como cada hilo lee
+	 * de todos los trozos de vector, el resultado se devuelve a vector después de una barrera.
 	 */
-	for (phase = 0; phase < size; phase++)
+	#pragma omp parallel
 	{
-		#pragma omp parallel for private(temp)
-		for (i = 1; i < size - (phase % 2); i += 2)
-			if (vector[i - 1 + (phase % 2)] > vector[i + (phase % 2)])
+		int q, b, j;
+
+		#pragma omp for schedule(static)
+		for (q = 0; q < nhilos; q++)
+		{
+			int ini = (long)q * size / nhilos, n = (long)(q + 1) * size / nhilos - ini;
+			quicksort_intro(vector + ini, n, profundidad_maxima(n));
+			fuentes[q] = vector + ini;
+			for (j = 0; j < SOBREMUESTREO; j++)
+				muestras[q * SOBREMUESTREO + j] = vector[ini + (long)n * (2 * j + 1) / (2 * SOBREMUESTREO)];
+		}
+
+		#pragma omp single
+		{
+			quicksort_intro(muestras, nmuestras, profundidad_maxima(nmuestras));
+			for (b = 0; b < nhilos - 1; b++) // separadores, en el mismo buffer
+				muestras[b] = muestras[(b + 1) * SOBREMUESTREO];
+		}
+
+		#pragma omp for schedule(static)
+		for (q = 0; q < nhilos; q++)
+		{ // La cubeta b tiene los componentes x con separador[b-1] <= x < separador[b]
+			int n = (long)(q + 1) * size / nhilos - (long)q * size / nhilos;
+			long *mios = cortes + (long)q * (nhilos + 1);
+			mios[0] = 0;
+			mios[nhilos] = n;
+			for (b = 1; b < nhilos; b++)
+				mios[b] = galope(muestras[b - 1], fuentes[q], n, FALSE);
+		}
+
+		#pragma omp for schedule(dynamic, 1) reduction(&& : correcto)
+		for (b = 0; b < nhilos; b++)
+		{
+			long destino = 0, *ini = limites + 2L * b * nhilos, *fin = ini + nhilos;
+			for (q = 0; q < nhilos; q++)
 			{
-				temp = vector[i];
-				vector[i] = vector[i - 1 + 2 * (phase % 2)];
-				vector[i - 1 + 2 * (phase % 2)] = temp;
+				ini[q] = cortes[(long)q * (nhilos + 1) + b];
+				fin[q] = cortes[(long)q * (nhilos + 1) + b + 1];
+				destino += ini[q];
 			}
+			correcto = mezcla_k(fuentes, ini, fin, nhilos, aux + destino) && correcto;
+		}
+
+		if (correcto)
+		{
+			#pragma omp for schedule(static)
+			for (j = 0; j < size; j++)
+				vector[j] = aux[j];
+		}
 	}
-} // Fin de ord_parDm
+	if (!correcto)
+		ord_parQ(vector, size); // Sin memoria para algún torneo: vector sigue intacto, con los trozos ordenados
+
+	liberaAlineada(aux);
+	free(muestras);
+	free(fuentes);
+	free(cortes);
+	free(limites);
+} // Fin de ord_parSk
 
-int main()
+// Estado de ord_parSk_ejecutor: un trozo y una cubeta por hilo
+struct muestreo_regular
 {
-	int i;
-	double t;
+	float *vector, *aux, *muestras;
+	const float **fuentes;
+	long *cortes, *limites; // como en ord_parSk
+	int size, n;
+	int correcto; // lo pone a FALSE la cubeta que se queda sin memoria para su torneo
+};
 
-	// 1. Dar valores aleatorios al vector en el intervalo [0, M[
-	srand((unsigned)time(NULL));
-	float faux;
-	for (i = 0; i < VECT_SIZE; i++)
+// Ordena el trozo q y toma sus muestras
+void ordena_muestras(struct ejecutor *e, const struct tarea *t)
+{
+	struct muestreo_regular *m = (struct muestreo_regular *)t->datos;
+	long q;
+	int j;
+	(void)e;
+	for (q = t->ini; q < t->fin; q++)
 	{
-		faux = (float)(rand() % RAND_MAX) / RAND_MAX;
-		// faux se distribuye con igual probabilidad a lo largo del intervalo [0,1[
-		vini[i] = M * faux;
+		int ini = q * m->size / m->n, n = (q + 1) * m->size / m->n - ini;
+		quicksort_intro(m->vector + ini, n, profundidad_maxima(n));
+		m->fuentes[q] = m->vector + ini;
+		for (j = 0; j < SOBREMUESTREO; j++)
+			m->muestras[q * SOBREMUESTREO + j] = m->vector[ini + (long)n * (2 * j + 1) / (2 * SOBREMUESTREO)];
 	}
+}
 
-	// 2. Imprimir vector desordenado (solo si el número de componentes no es muy grande)
-	if (VECT_SIZE <= 400)
+void corta_trozos(struct ejecutor *e, const struct tarea *t)
+{
+	struct muestreo_regular *m = (struct muestreo_regular *)t->datos;
+	long q;
+	int b;
+	(void)e;
+	for (q = t->ini; q < t->fin; q++)
 	{
-		printf("\nVector antes de ser ordenado: \n");
-		printVector(vini, VECT_SIZE);
+		int n = (q + 1) * m->size / m->n - q * m->size / m->n;
+		long *mios = m->cortes + q * (m->n + 1);
+		mios[0] = 0;
+		mios[m->n] = n;
+		for (b = 1; b < m->n; b++)
+			mios[b] = galope(m->muestras[b - 1], m->fuentes[q], n, FALSE);
 	}
+}
 
-	// 3. Para el primer método de ordenación, copiar vini en vord0, ordenar vord0 y comprobar que el vector queda ordenado
-	//	  Para el resto de métodos, copiar vini en vord, ordendar vord y comprobar que vord queda igual que vord0
-	//	  Para todos los métodos medir e imprimir el tiempo de copiar y ordenar el vector
-
-	for (i = 0; i < NM; i++)
+void mezcla_cubetas(struct ejecutor *e, const struct tarea *t)
+{
+	struct muestreo_regular *m = (struct muestreo_regular *)t->datos;
+	long b;
+	int q;
+	(void)e;
+	for (b = t->ini; b < t->fin; b++)
 	{
-		t = omp_get_wtime();
-		printf("=================================================================\n");
-		switch (i)
+		long destino = 0, *ini = m->limites + 2 * b * m->n, *fin = ini + m->n;
+		for (q = 0; q < m->n; q++)
 		{
-		case 0:
-			copiarVector(vord0, vini, VECT_SIZE); // vord0 <-- vini
-			printf("Ordenando por el método paralelo A\n");
-			ord_parA(vord0, VECT_SIZE);
-			printf("\nTiempo empleado por método paralelo A: %0.8f milisegundos\n", 1000 * (omp_get_wtime() - t));
-			if (estaOrdenado(vord0, VECT_SIZE))
-				printf("\nEl vector obtenido por el método paralelo A está ordenado\n");
-			else
-				printf("\nEl vector obtenido por el método paralelo A no está ordenado\n");
-			break;
-		case 1:
-			copiarVector(vord, vini, VECT_SIZE); // vord <-- vini
-			printf("Ordenando por el método paralelo B\n");
-			ord_parB(vord, VECT_SIZE);
-			printf("\nTiempo empleado por método paralelo B: %0.8f milisegundos\n", 1000 * (omp_get_wtime() - t));
-			if (vectoresIguales(vord0, vord, VECT_SIZE))
-				printf("\nEl vector obtenido por el método paralelo B coincide con el del método paralelo A\n");
-			else
-				printf("\nEl vector obtenido por el método paralelo B no coincide con el del método paralelo A\n");
-			break;
-		case 2:
-			copiarVector(vord, vini, VECT_SIZE); // vord <-- vini
-			printf("Ordenando por el método paralelo C\n");
-			ord_parC(vord, VECT_SIZE);
-			printf("\nTiempo empleado por método paralelo C: %0.8f milisegundos\n", 1000 * (omp_get_wtime() - t));
-			if (vectoresIguales(vord0, vord, VECT_SIZE))
-				printf("\nEl vector obtenido por el método paralelo C coincide con el del método paralelo A\n");
-			else
-				printf("\nEl vector obtenido por el método paralelo C no coincide con el del método paralelo A\n");
-			break;
-		case 3:
-			copiarVector(vord, vini, VECT_SIZE); // vord <-- vini
-			printf("Ordenando por el método paralelo D\n");
-			ord_parD(vord, VECT_SIZE);
-			printf("\nTiempo empleado por método paralelo D: %0.8f milisegundos\n", 1000 * (omp_get_wtime() - t));
-			if (vectoresIguales(vord0, vord, VECT_SIZE))
-				printf("\nEl vector obtenido por el método paralelo D coincide con el del método paralelo A\n");
-			else
-				printf("\nEl vector obtenido por el método paralelo D no coincide con el del método paralelo A\n");
-			break;
-		case 4:
-			copiarVector(vord, vini, VECT_SIZE); // vord <-- vini
-			printf("Ordenando por el método paralelo D mejorado\n");
-			ord_parDm(vord, VECT_SIZE);
-			printf("\nTiempo empleado por método paralelo D mejorado: %0.8f milisegundos\n", 1000 * (omp_get_wtime() - t));
-			if (vectoresIguales(vord0, vord, VECT_SIZE))
-				printf("\nEl vector obtenido por el método paralelo D mejorado coincide con el del método paralelo A\n");
-			else
-				printf("\nEl vector obtenido por el método paralelo D mejorado no coincide con el del método paralelo A\n");
-			break;
+			ini[q] = m->cortes[(long)q * (m->n + 1) + b];
+			fin[q] = m->cortes[(long)q * (m->n + 1) + b + 1];
+			destino += ini[q];
 		}
+		if (!mezcla_k(m->fuentes, ini, fin, m->n, m->aux + destino))
+			__atomic_store_n(&m->correcto, FALSE, __ATOMIC_RELAXED);
 	}
+}
+
+// ord_parSk en los hilos de un ejecutor: cada paso de la región de ord_parSk es una llamada a para
+void ord_parSk_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	struct muestreo_regular m = {vector, NULL, NULL, NULL, NULL, NULL, size, e->hilos, TRUE};
+	int b, nmuestras = m.n * SOBREMUESTREO;
 
-	// 4. Imprimir vector ordenado (solo si el número de componentes no es muy grande)
-	printf("=================================================================\n");
-	if (VECT_SIZE <= 400)
+	if ((m.n == 1) || (size < nmuestras * 16))
 	{
-		printf("\nVector ordenado: \n");
-		printVector(vord, VECT_SIZE);
+		ord_parQ_ejecutor(e, vector, size);
+		return;
 	}
-	printf("\n");
-}
+	m.aux = (float *)reservaAlineada_ejecutor(e, (long)size * sizeof(float));
+	m.muestras = (float *)malloc(nmuestras * sizeof(float));
+	m.fuentes = (const float **)malloc(m.n * sizeof(float *));
+	m.cortes = (long *)malloc((long)m.n * (m.n + 1) * sizeof(long));
+	m.limites = (long *)malloc(2L * m.n * m.n * sizeof(long));
+	if ((m.aux == NULL) || (m.muestras == NULL) || (m.fuentes == NULL) || (m.cortes == NULL) || (m.limites == NULL))
+	{
+		liberaAlineada(m.aux);
+		free(m.muestras);
+		free(m.fuentes);
+		free(m.cortes);
+		free(m.limites);
+		ord_parS_ejecutor(e, vector, size);
+		return;
+	}
+	e->para(e, m.n, ordena_muestras, &m);
+	quicksort_intro(m.muestras, nmuestras, profundidad_maxima(nmuestras));
+	for (b = 0; b < m.n - 1; b++)
+		m.muestras[b] = m.muestras[(b + 1) * SOBREMUESTREO];
+	e->para(e, m.n, corta_trozos, &m);
+	e->para(e, m.n, mezcla_cubetas, &m);
+	if (m.correcto)
+		copiarVector_ejecutor(e, vector, m.aux, size);
+	else
+		ord_parQ_ejecutor(e, vector, size);
+
+	liberaAlineada(m.aux);
+	free(m.muestras);
+	free(m.fuentes);
+	free(m.cortes);
+	free(m.limites);
+} // Fin de ord_parSk_ejecutor
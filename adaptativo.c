@@ -0,0 +1,249 @@
+/* Ordenación de un vector: punto de entrada único que elige el motor según el vector
+ *
+ * ordena() toma una muestra pequeña del vector (unos cientos de lecturas, sin recorrerlo entero) y estima:
+ *  - descensos: fracción de parejas contiguas desordenadas
+ *  - cambios: fracción de ternas contiguas en las que cambia el sentido (su inversa es la longitud media de los tramos
+ *    naturales, crecientes o decrecientes, que aprovecha ord_parAn)
+ *  - inversiones: fracción de parejas al azar desordenadas (0 ordenado, 0,5 al azar, 1 en orden inverso)
+ *  - duplicados: fracción de valores repetidos en la muestra
+ * y con esas estimaciones y el tamaño elige inserción, mezcla de tramos naturales, base (radix) o quicksort. Los umbrales de la decisión están
+ * en la variable global umbrales y se pueden medir en la máquina con calibraUmbrales. ordena_ejecutor hace lo mismo en los
+ * hilos de un ejecutor (ejecutor.c).
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdio.h>
+#include <limits.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define MUESTRA 256				// Lecturas de cada estimación
+#define REPETICIONES_CALIBRADO 5 // Se queda con la mejor de estas medidas
+#define ELEMENTOS_CALIBRADO (1 << 20) // Componentes que se ordenan en cada medida de tamaños pequeños (en varios vectores)
+
+// Mismo orden que las constantes MOTOR_* de ordena.h
+const char *motores[] = {"ordenado", "inserción", "mezcla", "base", "quicksort"};
+
+struct umbrales umbrales = {
+	64,		 // pequeno: hasta este tamaño, inserción directamente
+	4096,	 // casi: hasta este tamaño, inserción si la muestra no encuentra inversiones
+	32,		 // tramo: longitud media estimada de los tramos naturales a partir de la que se usa la mezcla
+	1 << 16, // base: desde este tamaño, ordenación por base...
+	0.99,	 // duplicados: ...salvo que casi todo sean duplicados (el quicksort de 3 vías los aprovecha; con 16 valores distintos
+			 // la ordenación por base todavía gana)
+};
+
+// Estimaciones sobre la muestra del vector (ver el comentario del principio del fichero)
+void muestrea(const float vector[], int size, double *descensos, double *cambios, double *inversiones, double *duplicados)
+{
+	int j, nd = 0, nc = 0, ni = 0, nu = 0;
+	float valores[MUESTRA];
+
+	for (j = 0; j < MUESTRA; j++)
+	{
+		long p = (long)j * (size - 2) / MUESTRA; // p + 2 < size, porque size > 2
+		long a = aleatorio64(0, 2, 2 * j) % size, b = aleatorio64(0, 2, 2 * j + 1) % size;
+		nd += (vector[p + 1] < vector[p]);
+		nc += ((vector[p + 1] < vector[p]) != (vector[p + 2] < vector[p + 1]));
+		if (a != b)
+			ni += (a < b) ? (vector[b] < vector[a]) : (vector[a] < vector[b]);
+		valores[j] = vector[a];
+	}
+	ordena_insercion(valores, MUESTRA);
+	for (j = 1; j < MUESTRA; j++)
+		nu += (valores[j] == valores[j - 1]);
+
+	*descensos = (double)nd / MUESTRA;
+	*cambios = (double)nc / MUESTRA;
+	*inversiones = (double)ni / MUESTRA;
+	*duplicados = (double)nu / (MUESTRA - 1);
+}
+
+void invierte(float vector[], int size)
+{
+	int i;
+	#pragma omp parallel for schedule(static)
+	for (i = 0; i < size / 2; i++)
+	{
+		float temp = vector[i];
+		vector[i] = vector[size - 1 - i];
+		vector[size - 1 - i] = temp;
+	}
+}
+
+struct inversion
+{
+	float *vector;
+	int size;
+};
+
+void invierte_trozo(struct ejecutor *e, const struct tarea *t)
+{
+	struct inversion *d = (struct inversion *)t->datos;
+	long i;
+	(void)e;
+	for (i = t->ini; i < t->fin; i++)
+	{
+		float temp = d->vector[i];
+		d->vector[i] = d->vector[d->size - 1 - i];
+		d->vector[d->size - 1 - i] = temp;
+	}
+}
+
+/* Motor que usaría ordena() para este vector, con la vuelta y la comprobación de orden en los hilos de e (con NULL, con
+ * directivas de OpenMP). Puede modificar el vector: si la muestra dice que está (casi) en orden inverso lo da la vuelta en
+ * paralelo y decide sobre el vector invertido, que queda ordenado o casi ordenado.
+ */
+int elige_motor(struct ejecutor *e, float vector[], int size)
+{
+	double descensos, cambios, inversiones, duplicados;
+	struct inversion d = {vector, size};
+
+	if (size <= max(umbrales.pequeno, 2))
+		return MOTOR_INSERCION;
+	muestrea(vector, size, &descensos, &cambios, &inversiones, &duplicados);
+
+	if (inversiones >= 0.9)
+	{
+		if (e == NULL)
+			invierte(vector, size);
+		else
+			e->para(e, size / 2, invierte_trozo, &d);
+		muestrea(vector, size, &descensos, &cambios, &inversiones, &duplicados);
+	}
+	if ((descensos == 0) && (((e == NULL) ? primerDesorden(vector, size) : primerDesorden_ejecutor(e, vector, size)) < 0))
+		return MOTOR_ORDENADO;
+	if ((inversiones == 0) && (size <= umbrales.casi))
+		return MOTOR_INSERCION; // Casi ordenado: la inserción hace size + n.º de inversiones pasos
+	if (cambios * umbrales.tramo <= 1)
+		return MOTOR_MEZCLA;
+	if ((size >= umbrales.base) && (duplicados <= umbrales.duplicados))
+		return MOTOR_BASE;
+	return MOTOR_QUICKSORT;
+}
+
+int eligeMotor(float vector[], int size)
+{
+	return elige_motor(NULL, vector, size);
+}
+
+void ordena(float vector[], int size)
+{
+	switch (eligeMotor(vector, size))
+	{
+	case MOTOR_ORDENADO:
+		break;
+	case MOTOR_INSERCION:
+		ordena_insercion(vector, size);
+		break;
+	case MOTOR_MEZCLA:
+		ord_parAn(vector, size);
+		break;
+	case MOTOR_BASE:
+		ord_parR(vector, size);
+		break;
+	default:
+		ord_parQ(vector, size);
+	}
+} // Fin de ordena
+
+// ordena() en los hilos de un ejecutor: la misma elección, con las versiones de los motores escritas sobre el ejecutor
+void ordena_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	switch (elige_motor(e, vector, size))
+	{
+	case MOTOR_ORDENADO:
+		break;
+	case MOTOR_INSERCION:
+		ordena_insercion(vector, size);
+		break;
+	case MOTOR_MEZCLA:
+		ord_parAn_ejecutor(e, vector, size);
+		break;
+	case MOTOR_BASE:
+		ord_parR_ejecutor(e, vector, size);
+		break;
+	default:
+		ord_parQ_ejecutor(e, vector, size);
+	}
+} // Fin de ordena_ejecutor
+
+// Mejor tiempo (segundos) de ordenar con "ordenacion" nvect copias de los size primeros componentes de origen
+double mide_motor(metodo_ordenacion ordenacion, const float origen[], float trabajo[], int size, int nvect)
+{
+	int r, v;
+	double t, mejor = 1e30;
+	for (r = 0; r < REPETICIONES_CALIBRADO; r++)
+	{
+		for (v = 0; v < nvect; v++)
+			copiarVector(trabajo + (long)v * size, (float *)origen, size);
+		t = omp_get_wtime();
+		for (v = 0; v < nvect; v++)
+			ordenacion(trabajo + (long)v * size, size);
+		t = omp_get_wtime() - t;
+		if (t < mejor)
+			mejor = t;
+	}
+	return mejor;
+}
+
+/* Mide en esta máquina, con los hilos actuales, los tamaños en los que cambia el motor más rápido y los deja en u:
+ *  - pequeno: mayor potencia de 2 con la que la inserción gana al quicksort paralelo (vectores uniformes)
+ *  - casi: mayor potencia de 2 con la que la inserción gana a la mezcla de tramos naturales con un vector casi ordenado
+ *    (size/1000 intercambios)
+ *  - base: menor tamaño (max_size, max_size/2, ...) desde el que la ordenación por base gana al quicksort en todos los medidos
+ * tramo y duplicados no se miden (se dejan como estén en u). Tarda unos segundos.
+ */
+void calibraUmbrales(struct umbrales *u, int max_size)
+{
+	int n, nvect;
+	float *origen = reservaVector(max(ELEMENTOS_CALIBRADO, max_size)), *trabajo = reservaVector(max(ELEMENTOS_CALIBRADO, max_size));
+
+	if ((origen == NULL) || (trabajo == NULL))
+	{
+		liberaAlineada(origen);
+		liberaAlineada(trabajo);
+		return;
+	}
+
+	u->pequeno = 4;
+	for (n = 8; n <= 4096; n *= 2)
+	{ // Muchos vectores pequeños seguidos, para que el tiempo sea medible
+		nvect = ELEMENTOS_CALIBRADO / n;
+		generaVector(origen, n, DIST_UNIFORME, 100, 1, 0);
+		if (mide_motor(ordena_insercion, origen, trabajo, n, nvect) <= mide_motor(ord_parQ, origen, trabajo, n, nvect))
+			u->pequeno = n;
+		else
+			break;
+	}
+
+	u->casi = u->pequeno;
+	for (n = 2 * u->pequeno; n <= max_size; n *= 2)
+	{
+		nvect = (n < ELEMENTOS_CALIBRADO) ? ELEMENTOS_CALIBRADO / n : 1;
+		generaVector(origen, n, DIST_CASI, 100, 1, (n >= 1000) ? n / 1000 : 1);
+		if (mide_motor(ordena_insercion, origen, trabajo, n, nvect) <= mide_motor(ord_parAn, origen, trabajo, n, nvect))
+			u->casi = n;
+		else
+			break;
+	}
+
+	u->base = INT_MAX; // Si no gana con ningún tamaño, nunca se usa (2 * max_size se podría salir de int)
+	for (n = max_size; n >= 1024; n /= 2)
+	{
+		nvect = (n < ELEMENTOS_CALIBRADO) ? ELEMENTOS_CALIBRADO / n : 1;
+		generaVector(origen, n, DIST_UNIFORME, 100, 1, 0);
+		if (mide_motor(ord_parR, origen, trabajo, n, nvect) < mide_motor(ord_parQ, origen, trabajo, n, nvect))
+			u->base = n;
+		else
+			break;
+	}
+
+	liberaAlineada(origen);
+	liberaAlineada(trabajo);
+}
@@ -0,0 +1,392 @@
+/* Ordenación de un vector: ordenación de claves float con un valor asociado (clave-valor) e índices de la ordenación (argsort)
+ *
+ * Las claves y los valores van en vectores separados (estructura de vectores): las claves siguen contiguas, así que las
+ * comparaciones se hacen sobre el mismo formato que en los métodos de solo claves. Los tres motores (mezcla, base y par-impar
+ * por bloques) son estables: con claves iguales los valores quedan en el orden en que estaban. Los valores son de 32 bits; los
+ * de 64 bits se ordenan calculando los índices de la ordenación y recolocándolos después (un acceso indirecto por valor).
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define CV_TRAMO 32		  // Los tramos iniciales del motor de mezcla se ordenan por inserción (estable)
+#define CV_MEZCLA_MIN 8192 // Por debajo de este n.º de componentes una mezcla no se reparte entre hilos
+
+// Mismo orden que las constantes CV_* de ordena.h
+const char *motores_cv[] = {"mezcla", "base", "par-impar"};
+
+// Inserción estable de (claves, valores): solo se desplaza lo que es estrictamente mayor
+void insercion_cv(float claves[], uint32_t valores[], int size)
+{
+	int i, j;
+	float x;
+	uint32_t y;
+	for (i = 1; i < size; i++)
+	{
+		x = claves[i];
+		y = valores[i];
+		for (j = i - 1; (0 <= j) && (x < claves[j]); j--)
+		{
+			claves[j + 1] = claves[j];
+			valores[j + 1] = valores[j];
+		}
+		claves[j + 1] = x;
+		valores[j + 1] = y;
+	}
+}
+
+// Mezcla estable de (ka, va) y (kb, vb) sobre (kd, vd): con claves iguales va primero la de a, como en mezcla_buffer
+void mezcla_cv(const float ka[], const uint32_t va[], int na, const float kb[], const uint32_t vb[], int nb,
+			   float kd[], uint32_t vd[])
+{
+	int i = 0, j = 0, k = 0, de_b;
+	while ((i < na) && (j < nb))
+	{ // Sin saltos que dependan de los datos
+		de_b = (kb[j] < ka[i]);
+		kd[k] = de_b ? kb[j] : ka[i];
+		vd[k++] = de_b ? vb[j] : va[i];
+		j += de_b;
+		i += 1 - de_b;
+	}
+	memcpy(kd + k, ka + i, (na - i) * sizeof(float));
+	memcpy(vd + k, va + i, (na - i) * sizeof(uint32_t));
+	k += na - i;
+	memcpy(kd + k, kb + j, (nb - j) * sizeof(float));
+	memcpy(vd + k, vb + j, (nb - j) * sizeof(uint32_t));
+}
+
+// Igual que mezcla_paralela: co_rango decide los empates igual que mezcla_cv, así que el reparto también es estable
+void mezcla_cv_paralela(const float ka[], const uint32_t va[], int na, const float kb[], const uint32_t vb[], int nb,
+						float kd[], uint32_t vd[])
+{
+	int p, np = omp_get_max_threads(), n = na + nb, *cortes;
+	if ((n < CV_MEZCLA_MIN) || (np == 1) || ((cortes = (int *)malloc((np + 1) * sizeof(int))) == NULL))
+	{
+		mezcla_cv(ka, va, na, kb, vb, nb, kd, vd);
+		return;
+	}
+	cortes_mezcla(ka, na, kb, nb, np, cortes);
+	#pragma omp parallel for schedule(static)
+	for (p = 0; p < np; p++)
+	{
+		int k0 = (long)p * n / np, k1 = (long)(p + 1) * n / np, i0 = cortes[p], i1 = cortes[p + 1];
+		mezcla_cv(ka + i0, va + i0, i1 - i0, kb + (k0 - i0), vb + (k0 - i0), (k1 - i1) - (k0 - i0), kd + k0, vd + k0);
+	}
+	free(cortes);
+}
+
+// Ordenación por mezcla estable en un solo hilo, con (kaux, vaux) de buffer del mismo tamaño; deja el resultado en (claves, valores)
+void ordena_cv_secuencial(float claves[], uint32_t valores[], int size, float kaux[], uint32_t vaux[])
+{
+	int p, ancho;
+	float *ko = claves, *kd = kaux, *kt;
+	uint32_t *vo = valores, *vd = vaux, *vt;
+
+	for (p = 0; p < size; p += CV_TRAMO)
+		insercion_cv(claves + p, valores + p, min(CV_TRAMO, size - p));
+	for (ancho = CV_TRAMO; ancho < size; ancho = 2 * ancho)
+	{
+		for (p = 0; p < size; p += 2 * ancho)
+		{
+			int med = min(p + ancho, size), fin = min(p + 2 * ancho, size);
+			mezcla_cv(ko + p, vo + p, med - p, ko + med, vo + med, fin - med, kd + p, vd + p);
+		}
+		kt = ko, ko = kd, kd = kt;
+		vt = vo, vo = vd, vd = vt;
+	}
+	if (ko != claves)
+	{
+		memcpy(claves, ko, size * sizeof(float));
+		memcpy(valores, vo, size * sizeof(uint32_t));
+	}
+}
+
+/* Motor de mezcla: el esquema de ord_parAm con parejas (clave, valor). Los tramos iniciales se ordenan por inserción en
+ * paralelo y en cada nivel se reparten las parejas de tramos entre los hilos o, cuando quedan pocas, cada mezcla entre todos.
+ */
+int cv_mezcla(float claves[], uint32_t valores[], int size)
+{
+	int ancho, p, npares, nhilos = omp_get_max_threads();
+	float *kaux = reservaVector(size), *ko, *kd, *kt;
+	uint32_t *vaux = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t)), *vo, *vd, *vt;
+
+	if ((kaux == NULL) || (vaux == NULL))
+	{
+		liberaAlineada(kaux);
+		liberaAlineada(vaux);
+		return FALSE;
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (p = 0; p < size; p += CV_TRAMO)
+		insercion_cv(claves + p, valores + p, min(CV_TRAMO, size - p));
+
+	ko = claves, kd = kaux;
+	vo = valores, vd = vaux;
+	for (ancho = CV_TRAMO; ancho < size; ancho = 2 * ancho)
+	{
+		npares = (size - 1) / (2 * ancho) + 1;
+		if (npares >= nhilos)
+		{
+			#pragma omp parallel for schedule(static)
+			for (p = 0; p < npares; p++)
+			{
+				int ini = 2 * ancho * p, med = min(ini + ancho, size), fin = min(ini + 2 * ancho, size);
+				mezcla_cv(ko + ini, vo + ini, med - ini, ko + med, vo + med, fin - med, kd + ini, vd + ini);
+			}
+		}
+		else
+			for (p = 0; p < npares; p++)
+			{
+				int ini = 2 * ancho * p, med = min(ini + ancho, size), fin = min(ini + 2 * ancho, size);
+				mezcla_cv_paralela(ko + ini, vo + ini, med - ini, ko + med, vo + med, fin - med, kd + ini, vd + ini);
+			}
+		kt = ko, ko = kd, kd = kt;
+		vt = vo, vo = vd, vd = vt;
+	}
+
+	if (ko != claves)
+	{
+		#pragma omp parallel for schedule(static)
+		for (p = 0; p < size; p++)
+		{
+			claves[p] = ko[p];
+			valores[p] = vo[p];
+		}
+	}
+	liberaAlineada(kaux);
+	liberaAlineada(vaux);
+	return TRUE;
+}
+
+/* Motor de base: el de ord_parR (pasadas_base: LSD, una región paralela, histogramas por hilo y una suma prefija por pasada)
+ * moviendo el valor junto con la clave. El reparto de cada pasada conserva el orden relativo, así que es estable. Las claves
+ * enteras se hacen con clave_valor, que convierte -0 en +0: así empatan como con < (con clave_float todos los -0 irían antes
+ * que los +0); a cambio, los -0 vuelven como +0.
+ */
+int cv_base(float claves[], uint32_t valores[], int size)
+{
+	int nhilos = omp_get_max_threads();
+	uint32_t *c = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+	uint32_t *caux = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+	uint32_t *vaux = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+	int *cuenta = (int *)malloc(nhilos * RADIX_CUBETAS * sizeof(int)); // cuenta[hilo][cubeta]
+	struct ordenacion_base o = {c, caux, valores, vaux, size, 4, cuenta, FALSE};
+
+	if ((c == NULL) || (caux == NULL) || (vaux == NULL) || (cuenta == NULL))
+	{
+		liberaAlineada(c);
+		liberaAlineada(caux);
+		liberaAlineada(vaux);
+		free(cuenta);
+		return FALSE;
+	}
+
+	#pragma omp parallel
+	{
+		int i, en_aux, t = omp_get_thread_num(), nt = omp_get_num_threads();
+		int ini = (long)t * size / nt, fin = (long)(t + 1) * size / nt;
+
+		for (i = ini; i < fin; i++)
+			c[i] = clave_valor(claves[i]);
+		en_aux = pasadas_base(&o);
+		for (i = ini; i < fin; i++)
+		{
+			claves[i] = float_clave(en_aux ? caux[i] : c[i]);
+			if (en_aux)
+				valores[i] = vaux[i];
+		}
+	}
+
+	liberaAlineada(c);
+	liberaAlineada(caux);
+	liberaAlineada(vaux);
+	free(cuenta);
+	return TRUE;
+}
+
+/* Motor par-impar por bloques: el esquema de ord_parDb. Cada hilo ordena su bloque con la mezcla estable y en cada fase las
+ * parejas de bloques vecinos se mezclan (estable) y se vuelven a partir; la pareja se salta si ya está en orden.
+ */
+int cv_parimpar(float claves[], uint32_t valores[], int size)
+{
+	int nbloques = omp_get_max_threads(), tam = (size + nbloques - 1) / nbloques;
+	float *kaux = reservaVector(size);
+	uint32_t *vaux = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+
+	if ((kaux == NULL) || (vaux == NULL))
+	{
+		liberaAlineada(kaux);
+		liberaAlineada(vaux);
+		return FALSE;
+	}
+
+	#pragma omp parallel
+	{
+		int b, fase;
+
+		#pragma omp for schedule(static)
+		for (b = 0; b < nbloques; b++)
+		{
+			int ini = min((long)b * tam, size), fin = min((long)(b + 1) * tam, size);
+			ordena_cv_secuencial(claves + ini, valores + ini, fin - ini, kaux + ini, vaux + ini);
+		}
+
+		for (fase = 0; fase < nbloques; fase++)
+		{
+			#pragma omp for schedule(static)
+			for (b = fase % 2; b < nbloques - 1; b += 2)
+			{
+				int ini = min((long)b * tam, size), med = min((long)(b + 1) * tam, size), fin = min((long)(b + 2) * tam, size);
+				if ((ini < med) && (med < fin) && (claves[med] < claves[med - 1]))
+				{
+					mezcla_cv(claves + ini, valores + ini, med - ini, claves + med, valores + med, fin - med, kaux + ini, vaux + ini);
+					memcpy(claves + ini, kaux + ini, (fin - ini) * sizeof(float));
+					memcpy(valores + ini, vaux + ini, (fin - ini) * sizeof(uint32_t));
+				}
+			}
+		}
+	}
+
+	liberaAlineada(kaux);
+	liberaAlineada(vaux);
+	return TRUE;
+}
+
+/* Ordena claves y mueve con cada una su valor de 32 bits (motor: CV_MEZCLA, CV_BASE o CV_PARIMPAR). Estable.
+ * Devuelve FALSE, sin tocar nada, si no hay memoria para los buffers.
+ */
+int ordenaClaveValor(float claves[], uint32_t valores[], int size, int motor)
+{
+	switch (motor)
+	{
+	case CV_BASE:
+		return cv_base(claves, valores, size);
+	case CV_PARIMPAR:
+		return cv_parimpar(claves, valores, size);
+	default:
+		return cv_mezcla(claves, valores, size);
+	}
+}
+
+// Índices de la ordenación estable de claves (claves[indices[0]] <= claves[indices[1]] <= ...), sin modificar claves
+int ordenaIndices(const float claves[], uint32_t indices[], int size, int motor)
+{
+	int i, hecho;
+	float *copia = reservaVector(size);
+	if (copia == NULL)
+		return FALSE;
+	#pragma omp parallel for schedule(static)
+	for (i = 0; i < size; i++)
+	{
+		copia[i] = claves[i];
+		indices[i] = i;
+	}
+	hecho = ordenaClaveValor(copia, indices, size, motor);
+	liberaAlineada(copia);
+	return hecho;
+}
+
+/* Ordena claves y mueve con cada una su valor de 64 bits: se ordenan las claves con su índice (así los motores siguen
+ * moviendo 4 + 4 bytes) y después se recolocan los valores en paralelo con un acceso indirecto.
+ */
+int ordenaClaveValor64(float claves[], uint64_t valores[], int size, int motor)
+{
+	int i, hecho = FALSE;
+	uint32_t *indices = (uint32_t *)reservaAlineada((long)size * sizeof(uint32_t));
+	uint64_t *aux = (uint64_t *)reservaAlineada((long)size * sizeof(uint64_t));
+
+	if ((indices != NULL) && (aux != NULL))
+	{
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			indices[i] = i;
+		if ((hecho = ordenaClaveValor(claves, indices, size, motor)))
+		{
+			#pragma omp parallel for schedule(static)
+			for (i = 0; i < size; i++)
+				aux[i] = valores[indices[i]];
+			#pragma omp parallel for schedule(static)
+			for (i = 0; i < size; i++)
+				valores[i] = aux[i];
+		}
+	}
+	liberaAlineada(indices);
+	liberaAlineada(aux);
+	return hecho;
+}
+
+/* Alternativa con la que se comparan los motores: empaquetar cada pareja en una palabra de 64 bits (clave en la mitad alta,
+ * índice en la baja) y ordenar las palabras por base sobre los 32 bits altos. Es estable por serlo la ordenación por base,
+ * pero cada pasada mueve la palabra entera y los registros SIMD tienen la mitad de claves que con los vectores separados.
+ * Como en cv_base, la clave es la de clave_valor para que -0 y +0 empaten.
+ */
+int ordenaIndicesEmpaquetado(const float claves[], uint32_t indices[], int size)
+{
+	int nhilos = omp_get_max_threads();
+	uint64_t *w = (uint64_t *)reservaAlineada((long)size * sizeof(uint64_t));
+	uint64_t *waux = (uint64_t *)reservaAlineada((long)size * sizeof(uint64_t));
+	int *cuenta = (int *)malloc(nhilos * RADIX_CUBETAS * sizeof(int));
+	struct ordenacion_base o = {w, waux, NULL, NULL, size, 8, cuenta, FALSE};
+
+	if ((w == NULL) || (waux == NULL) || (cuenta == NULL))
+	{
+		liberaAlineada(w);
+		liberaAlineada(waux);
+		free(cuenta);
+		return FALSE;
+	}
+
+	#pragma omp parallel
+	{
+		int i, t = omp_get_thread_num(), nt = omp_get_num_threads();
+		int ini = (long)t * size / nt, fin = (long)(t + 1) * size / nt;
+		uint64_t *resultado;
+
+		for (i = ini; i < fin; i++)
+			w[i] = ((uint64_t)clave_valor(claves[i]) << 32) | (uint32_t)i;
+		resultado = pasadas_base(&o) ? waux : w;
+		for (i = ini; i < fin; i++)
+			indices[i] = (uint32_t)resultado[i];
+	}
+
+	liberaAlineada(w);
+	liberaAlineada(waux);
+	free(cuenta);
+	return TRUE;
+}
+
+/* Comprueba que indices es una permutación que ordena claves de forma estable. Devuelve la primera posición i en la que
+ * falla (índice repetido o fuera de rango, claves[indices[i]] > claves[indices[i+1]] o, con claves iguales, índices que no
+ * van en orden creciente) o -1 si es correcta.
+ */
+int compruebaIndices(const float claves[], const uint32_t indices[], int size)
+{
+	int i, primera = size;
+	char *visto = (char *)calloc(size > 0 ? size : 1, 1);
+
+	for (i = 0; (i < size) && (primera == size); i++)
+		if ((indices[i] >= (uint32_t)size) || visto[indices[i]])
+			primera = i;
+		else
+			visto[indices[i]] = 1;
+	free(visto);
+
+	#pragma omp parallel for schedule(static) reduction(min : primera)
+	for (i = 0; i < size - 1; i++)
+		if ((indices[i] < (uint32_t)size) && (indices[i + 1] < (uint32_t)size))
+		{
+			float a = claves[indices[i]], b = claves[indices[i + 1]];
+			if ((b < a) || ((a == b) && (indices[i + 1] < indices[i])))
+				primera = min(primera, i);
+		}
+	return (primera == size) ? -1 : primera;
+}
@@ -0,0 +1,466 @@
+/* Ordenación de un vector: ejecutores (en qué hilos se ejecuta el trabajo de un método paralelo)
+ *
+ * Un ejecutor ofrece las tres operaciones que usan los métodos portados (los ord_parX_ejecutor de OrdenaVectorOMP.c,
+ * ordena_ejecutor, mezclaK_ejecutor, copiarVector_ejecutor y reservaAlineada_ejecutor):
+ *  - para: ejecuta cuerpo sobre los índices [0, n), repartidos en trozos entre los hilos, y vuelve cuando han terminado todos
+ *  - ejecuta: ejecuta una tarea raíz y todas las que se lancen desde ella (y desde esas), y vuelve cuando han terminado todas
+ *  - lanza: desde dentro de una tarea, deja otra para cualquier hilo
+ * Hay dos: creaEjecutorOpenMP (regiones paralelas, omp for y omp task, como los métodos de siempre) y creaEjecutorRobo (hilos
+ * propios con robo de trabajo). Un programa que ya tiene su propio conjunto de hilos puede rellenar un struct ejecutor con sus
+ * funciones (para puede ser paraTareas, que solo usa ejecuta y lanza) y los métodos se ejecutan en sus hilos, sin levantar
+ * un equipo de OpenMP encima de ellos.
+ *
+ * Robo de trabajo: cada hilo tiene una cola doble de Chase-Lev sin cerrojos (la versión de Lê et al. para memoria débil, con
+ * capacidad fija): el dueño mete y saca tareas por abajo y los demás roban por arriba con un CAS, así que el dueño solo compite
+ * con un ladrón por la última tarea. Con la cola llena, la tarea se ejecuta en el acto en el hilo que la lanza. El hilo que
+ * llama a ejecuta o a para trabaja como uno más (es el hilo 0) hasta que terminan las tareas de su grupo; los demás buscan
+ * trabajo (en su cola y después robando, a partir de una víctima al azar), ceden la CPU tras cada ronda sin éxito y, tras
+ * ESPERA_ACTIVA rondas, se duermen hasta el siguiente ejecuta o lanza. Así una ordenación pequeña que llega poco después de la
+ * anterior no paga ni crear hilos ni despertarlos. Cada tarea pertenece al grupo de la llamada a ejecuta de la que sale, lo
+ * que permite llamar a ejecuta (o a para) desde dentro de una tarea. Con fijar, cada hilo se ata a una CPU distinta de las
+ * que tiene permitidas el proceso (el hilo que llama no se toca).
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE // pthread_setaffinity_np
+#endif
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define COLA_TAREAS 4096	  // Capacidad de la cola de cada hilo (potencia de 2)
+#define ESPERA_ACTIVA 2000	  // Rondas sin encontrar trabajo antes de dormir
+#define TROZOS_POR_HILO 4	  // paraTareas parte el rango en unos TROZOS_POR_HILO trozos por hilo
+#ifndef CPU_SETSIZE
+#define CPU_SETSIZE 1 // Sin sched_getaffinity no se fija ningún hilo
+#endif
+
+// Tareas pendientes (lanzadas y sin terminar) de una llamada a ejecuta
+struct grupo_tareas
+{
+	atomic_long pendientes;
+};
+
+// Cola doble de Chase-Lev: arriba y abajo en líneas de caché distintas, porque arriba la tocan los ladrones
+struct cola_robo
+{
+	_Alignas(64) atomic_long arriba;
+	_Alignas(64) atomic_long abajo;
+	struct tarea *ranuras;
+};
+
+// Arranque de cada hilo del ejecutor de robo
+struct arranque_robo
+{
+	struct estado_robo *r;
+	int hilo;
+};
+
+struct estado_robo
+{
+	struct ejecutor *e;
+	struct cola_robo *colas; // colas[0] es la del hilo que llama
+	pthread_t *hilos;		 // hilos[1..hilos-1]
+	pthread_mutex_t cerrojo; // para dormir y despertar...
+	pthread_cond_t despierta;
+	pthread_mutex_t llamada; // ...y para que los hilos de fuera llamen de uno en uno
+	atomic_long generacion;	 // cambia al despertar a los dormidos
+	atomic_int dormidos, fin;
+	int fijar, ncpus, *cpus; // CPUs permitidas al proceso
+	struct arranque_robo *arranques;
+};
+
+// Hilo actual: su ejecutor de robo (NULL si no es de ninguno), su n.º en él y el grupo de la tarea que está ejecutando
+_Thread_local struct estado_robo *robo_actual = NULL;
+_Thread_local int hilo_actual = 0;
+_Thread_local struct grupo_tareas *grupo_actual = NULL;
+
+/* Las ranuras de la cola se leen y escriben campo a campo con accesos atómicos relajados: un ladrón puede leer una ranura que
+ * el dueño está reescribiendo, pero en ese caso su CAS sobre arriba falla y descarta lo leído.
+ */
+void guarda_tarea(struct tarea *ranura, const struct tarea *t)
+{
+	__atomic_store_n(&ranura->cuerpo, t->cuerpo, __ATOMIC_RELAXED);
+	__atomic_store_n(&ranura->datos, t->datos, __ATOMIC_RELAXED);
+	__atomic_store_n(&ranura->ini, t->ini, __ATOMIC_RELAXED);
+	__atomic_store_n(&ranura->fin, t->fin, __ATOMIC_RELAXED);
+	__atomic_store_n(&ranura->nivel, t->nivel, __ATOMIC_RELAXED);
+	__atomic_store_n(&ranura->grupo, t->grupo, __ATOMIC_RELAXED);
+}
+
+void lee_tarea(struct tarea *t, struct tarea *ranura)
+{
+	t->cuerpo = __atomic_load_n(&ranura->cuerpo, __ATOMIC_RELAXED);
+	t->datos = __atomic_load_n(&ranura->datos, __ATOMIC_RELAXED);
+	t->ini = __atomic_load_n(&ranura->ini, __ATOMIC_RELAXED);
+	t->fin = __atomic_load_n(&ranura->fin, __ATOMIC_RELAXED);
+	t->nivel = __atomic_load_n(&ranura->nivel, __ATOMIC_RELAXED);
+	t->grupo = __atomic_load_n(&ranura->grupo, __ATOMIC_RELAXED);
+}
+
+// Solo el dueño: FALSE si la cola está llena
+int mete(struct cola_robo *c, const struct tarea *t)
+{
+	long b = atomic_load_explicit(&c->abajo, memory_order_relaxed);
+	long a = atomic_load_explicit(&c->arriba, memory_order_acquire);
+	if (b - a >= COLA_TAREAS)
+		return FALSE;
+	guarda_tarea(&c->ranuras[b & (COLA_TAREAS - 1)], t);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&c->abajo, b + 1, memory_order_relaxed);
+	return TRUE;
+}
+
+// Solo el dueño: saca la última que metió
+int saca(struct cola_robo *c, struct tarea *t)
+{
+	long b = atomic_load_explicit(&c->abajo, memory_order_relaxed) - 1, a;
+	int hay = TRUE;
+	atomic_store_explicit(&c->abajo, b, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	a = atomic_load_explicit(&c->arriba, memory_order_relaxed);
+	if (a <= b)
+	{
+		lee_tarea(t, &c->ranuras[b & (COLA_TAREAS - 1)]);
+		if (a == b)
+		{ // Es la última: se la disputa con los ladrones
+			hay = atomic_compare_exchange_strong_explicit(&c->arriba, &a, a + 1, memory_order_seq_cst, memory_order_relaxed);
+			atomic_store_explicit(&c->abajo, b + 1, memory_order_relaxed);
+		}
+	}
+	else
+	{
+		hay = FALSE;
+		atomic_store_explicit(&c->abajo, b + 1, memory_order_relaxed);
+	}
+	return hay;
+}
+
+// Cualquier otro hilo: roba la más antigua
+int roba(struct cola_robo *c, struct tarea *t)
+{
+	long a = atomic_load_explicit(&c->arriba, memory_order_acquire), b;
+	atomic_thread_fence(memory_order_seq_cst);
+	b = atomic_load_explicit(&c->abajo, memory_order_acquire);
+	if (a >= b)
+		return FALSE;
+	lee_tarea(t, &c->ranuras[a & (COLA_TAREAS - 1)]);
+	return atomic_compare_exchange_strong_explicit(&c->arriba, &a, a + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+int hay_tareas(struct estado_robo *r)
+{
+	int h;
+	for (h = 0; h < r->e->hilos; h++)
+		if (atomic_load(&r->colas[h].arriba) < atomic_load(&r->colas[h].abajo))
+			return TRUE;
+	return FALSE;
+}
+
+// Busca trabajo: primero en la cola propia y después en las demás, empezando por una al azar (xorshift de cada hilo)
+int busca_tarea(struct estado_robo *r, int yo, unsigned *azar, struct tarea *t)
+{
+	int v, k, h = r->e->hilos;
+	if (saca(&r->colas[yo], t))
+		return TRUE;
+	*azar ^= *azar << 13;
+	*azar ^= *azar >> 17;
+	*azar ^= *azar << 5;
+	for (k = 0, v = *azar % h; k < h; k++, v = (v + 1 == h) ? 0 : v + 1)
+		if ((v != yo) && roba(&r->colas[v], t))
+			return TRUE;
+	return FALSE;
+}
+
+void ejecuta_tarea(struct ejecutor *e, struct tarea *t)
+{
+	struct grupo_tareas *anterior = grupo_actual;
+	grupo_actual = t->grupo;
+	t->cuerpo(e, t);
+	grupo_actual = anterior;
+	atomic_fetch_sub_explicit(&t->grupo->pendientes, 1, memory_order_release);
+}
+
+void despierta_dormidos(struct estado_robo *r)
+{
+	pthread_mutex_lock(&r->cerrojo);
+	atomic_fetch_add(&r->generacion, 1);
+	pthread_cond_broadcast(&r->despierta);
+	pthread_mutex_unlock(&r->cerrojo);
+}
+
+void *trabajador(void *arg)
+{
+	struct arranque_robo *a = (struct arranque_robo *)arg;
+	struct estado_robo *r = a->r;
+	struct tarea t;
+	unsigned azar = 2654435761u * (unsigned)a->hilo;
+	long vista;
+	int fallos = 0;
+
+#ifdef __linux__
+	if (r->fijar && (r->ncpus > 0))
+	{
+		cpu_set_t cpu;
+		CPU_ZERO(&cpu);
+		CPU_SET(r->cpus[a->hilo % r->ncpus], &cpu);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpu), &cpu); // Si falla, el hilo sigue sin fijar
+	}
+#endif
+	robo_actual = r;
+	hilo_actual = a->hilo;
+	while (!atomic_load(&r->fin))
+	{
+		if (busca_tarea(r, hilo_actual, &azar, &t))
+		{
+			ejecuta_tarea(r->e, &t);
+			fallos = 0;
+		}
+		else if (++fallos < ESPERA_ACTIVA)
+			sched_yield();
+		else
+		{ // A dormir, salvo que haya llegado trabajo entre la última búsqueda y anotarse como dormido (ver lanza_robo)
+			vista = atomic_load(&r->generacion);
+			pthread_mutex_lock(&r->cerrojo);
+			atomic_fetch_add(&r->dormidos, 1);
+			if ((atomic_load(&r->generacion) == vista) && !hay_tareas(r) && !atomic_load(&r->fin))
+				pthread_cond_wait(&r->despierta, &r->cerrojo);
+			atomic_fetch_sub(&r->dormidos, 1);
+			pthread_mutex_unlock(&r->cerrojo);
+			fallos = 0;
+		}
+	}
+	return NULL;
+}
+
+/* Desde dentro de una tarea: la nueva va a la cola del hilo actual y es del mismo grupo. Después de meterla se mira si hay
+ * dormidos; como el hilo que se duerme se anota antes de mirar por última vez las colas, o este ve que hay uno dormido y lo
+ * despierta o aquel ve la tarea.
+ */
+void lanza_robo(struct ejecutor *e, const struct tarea *t)
+{
+	struct estado_robo *r = (struct estado_robo *)e->estado;
+	struct tarea nueva = *t;
+
+	nueva.grupo = grupo_actual;
+	atomic_fetch_add_explicit(&nueva.grupo->pendientes, 1, memory_order_relaxed);
+	if ((robo_actual != r) || !mete(&r->colas[hilo_actual], &nueva))
+	{ // Cola llena (o un hilo que no es del ejecutor): se ejecuta aquí
+		ejecuta_tarea(e, &nueva);
+		return;
+	}
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&r->dormidos) > 0)
+		despierta_dormidos(r);
+}
+
+void ejecuta_robo(struct ejecutor *e, const struct tarea *raiz)
+{
+	struct estado_robo *r = (struct estado_robo *)e->estado;
+	struct grupo_tareas grupo;
+	struct tarea t = *raiz;
+	int de_fuera = (robo_actual != r);
+	unsigned azar = 88172645u;
+
+	if (de_fuera)
+	{ // El hilo que llama pasa a ser el hilo 0 del ejecutor mientras dure la llamada
+		pthread_mutex_lock(&r->llamada);
+		robo_actual = r;
+		hilo_actual = 0;
+	}
+	atomic_init(&grupo.pendientes, 1);
+	t.grupo = &grupo;
+	ejecuta_tarea(e, &t);
+	while (atomic_load_explicit(&grupo.pendientes, memory_order_acquire) > 0)
+		if (busca_tarea(r, hilo_actual, &azar, &t))
+			ejecuta_tarea(e, &t);
+	if (de_fuera)
+	{
+		robo_actual = NULL;
+		pthread_mutex_unlock(&r->llamada);
+	}
+}
+
+// Reparto de paraTareas: cada tarea lanza la mitad derecha de su rango mientras sea mayor que el grano
+struct para_tareas
+{
+	cuerpo_tarea cuerpo;
+	void *datos;
+	long grano;
+};
+
+void parte_rango(struct ejecutor *e, const struct tarea *t)
+{
+	struct para_tareas *p = (struct para_tareas *)t->datos;
+	struct tarea trozo = *t;
+	while (trozo.fin - trozo.ini > p->grano)
+	{
+		struct tarea derecha = trozo;
+		derecha.ini = trozo.ini + (trozo.fin - trozo.ini) / 2;
+		e->lanza(e, &derecha);
+		trozo.fin = derecha.ini;
+	}
+	trozo.cuerpo = p->cuerpo;
+	trozo.datos = p->datos;
+	p->cuerpo(e, &trozo);
+}
+
+void paraTareas(struct ejecutor *e, long n, cuerpo_tarea cuerpo, void *datos)
+{
+	struct para_tareas p = {cuerpo, datos, max((n + (long)TROZOS_POR_HILO * e->hilos - 1) / ((long)TROZOS_POR_HILO * e->hilos), 1L)};
+	struct tarea raiz = {parte_rango, &p, 0, n, 0, NULL};
+	if (n > 0)
+		e->ejecuta(e, &raiz);
+}
+
+// Libera el estado de un ejecutor de robo sin hilos en marcha, con las ranuras de sus ncolas primeras colas
+void libera_estado(struct estado_robo *r, int ncolas)
+{
+	int h;
+	for (h = 0; (r->colas != NULL) && (h < ncolas); h++)
+		free(r->colas[h].ranuras);
+	pthread_mutex_destroy(&r->cerrojo);
+	pthread_mutex_destroy(&r->llamada);
+	pthread_cond_destroy(&r->despierta);
+	liberaAlineada(r->colas);
+	free(r->hilos);
+	free(r->cpus);
+	free(r->arranques);
+	free(r);
+}
+
+int creaEjecutorRobo(struct ejecutor *e, int hilos, int fijar)
+{
+	struct estado_robo *r = (struct estado_robo *)calloc(1, sizeof(struct estado_robo));
+	int h, correcto;
+
+	e->nombre = "robo de trabajo";
+	e->hilos = (hilos > 0) ? hilos : omp_get_max_threads();
+	e->para = paraTareas;
+	e->ejecuta = ejecuta_robo;
+	e->lanza = lanza_robo;
+	e->estado = r;
+	if (r == NULL)
+		return FALSE;
+	r->e = e;
+	r->fijar = fijar;
+	pthread_mutex_init(&r->cerrojo, NULL);
+	pthread_mutex_init(&r->llamada, NULL);
+	pthread_cond_init(&r->despierta, NULL);
+	r->colas = (struct cola_robo *)reservaAlineada(e->hilos * sizeof(struct cola_robo));
+	r->hilos = (pthread_t *)calloc(e->hilos, sizeof(pthread_t));
+	r->cpus = (int *)malloc(CPU_SETSIZE * sizeof(int));
+	r->arranques = (struct arranque_robo *)malloc(e->hilos * sizeof(struct arranque_robo));
+	correcto = (r->colas != NULL) && (r->hilos != NULL) && (r->cpus != NULL) && (r->arranques != NULL);
+	for (h = 0; correcto && (h < e->hilos); h++)
+	{
+		atomic_init(&r->colas[h].arriba, 0);
+		atomic_init(&r->colas[h].abajo, 0);
+		correcto = ((r->colas[h].ranuras = (struct tarea *)malloc(COLA_TAREAS * sizeof(struct tarea))) != NULL);
+	}
+	if (!correcto)
+	{
+		libera_estado(r, h);
+		e->estado = NULL;
+		return FALSE;
+	}
+#ifdef __linux__
+	{
+		cpu_set_t permitidas;
+		if (sched_getaffinity(0, sizeof(permitidas), &permitidas) == 0)
+			for (h = 0; h < CPU_SETSIZE; h++)
+				if (CPU_ISSET(h, &permitidas))
+					r->cpus[r->ncpus++] = h;
+	}
+#endif
+	atomic_init(&r->generacion, 0);
+	atomic_init(&r->dormidos, 0);
+	atomic_init(&r->fin, FALSE);
+	for (h = 1; h < e->hilos; h++)
+	{
+		r->arranques[h].r = r;
+		r->arranques[h].hilo = h;
+		if (pthread_create(&r->hilos[h], NULL, trabajador, &r->arranques[h]) != 0)
+			break;
+	}
+	if (h < e->hilos)
+	{ // No se han podido crear todos los hilos: se paran los que haya
+		atomic_store(&r->fin, TRUE);
+		despierta_dormidos(r);
+		while (--h >= 1)
+			pthread_join(r->hilos[h], NULL);
+		libera_estado(r, e->hilos);
+		e->estado = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// Ejecutor OpenMP: para es un omp for estático con un trozo por hilo y las tareas son tareas de OpenMP
+void para_openmp(struct ejecutor *e, long n, cuerpo_tarea cuerpo, void *datos)
+{
+	int b, nb = (int)min((long)e->hilos, n);
+	#pragma omp parallel for schedule(static) num_threads(max(nb, 1))
+	for (b = 0; b < nb; b++)
+	{
+		struct tarea t = {cuerpo, datos, n * b / nb, n * (b + 1) / nb, 0, NULL};
+		cuerpo(e, &t);
+	}
+}
+
+void ejecuta_openmp(struct ejecutor *e, const struct tarea *raiz)
+{
+	struct tarea t = *raiz;
+	if (omp_in_parallel())
+	{ // Dentro de una tarea: el grupo de tareas espera a las que salgan de esta raíz
+		#pragma omp taskgroup
+		t.cuerpo(e, &t);
+	}
+	else
+	{ // Como en ord_parQ: un hilo ejecuta la raíz y los demás las tareas; la barrera del final espera a todas
+		#pragma omp parallel num_threads(e->hilos)
+		#pragma omp single
+		t.cuerpo(e, &t);
+	}
+}
+
+void lanza_openmp(struct ejecutor *e, const struct tarea *t)
+{
+	struct tarea copia = *t;
+	#pragma omp task firstprivate(copia)
+	copia.cuerpo(e, &copia);
+}
+
+int creaEjecutorOpenMP(struct ejecutor *e, int hilos)
+{
+	e->nombre = "OpenMP";
+	e->hilos = (hilos > 0) ? hilos : omp_get_max_threads();
+	e->para = para_openmp;
+	e->ejecuta = ejecuta_openmp;
+	e->lanza = lanza_openmp;
+	e->estado = NULL;
+	return TRUE;
+}
+
+void liberaEjecutor(struct ejecutor *e)
+{
+	struct estado_robo *r = (struct estado_robo *)e->estado;
+	int h;
+	if (r == NULL)
+		return;
+	atomic_store(&r->fin, TRUE);
+	despierta_dormidos(r);
+	for (h = 1; h < e->hilos; h++)
+		pthread_join(r->hilos[h], NULL);
+	libera_estado(r, e->hilos);
+	e->estado = NULL;
+}
@@ -0,0 +1,473 @@
+/* Ordenación de un vector: ordenación externa de ficheros de floats que no caben en memoria
+ *
+ * El fichero de entrada es un vector de floats en binario (el formato de la máquina, sin cabecera). Dos fases:
+ *  1. Tramos: se lee el fichero por trozos que caben en memoria, cada trozo se ordena en paralelo con ordena() (el motor
+ *     adaptativo) y se escribe como tramo ordenado en un fichero temporal.
+ *  2. Mezcla: los tramos se mezclan con el árbol de perdedores de torneo.c, leyendo cada tramo por bloques. Si son tantos
+ *     que los bloques de una sola mezcla serían de menos de BLOQUE_MIN componentes, se mezclan por grupos en tramos más
+ *     largos (en otros ficheros temporales), tantas pasadas como haga falta, hasta que caben en la mezcla final.
+ * La entrada y salida no la hacen los hilos que ordenan sino un hilo propio (servicio de E/S) que atiende peticiones de
+ * lectura y escritura en orden. En la fase 1 hay tres trozos en memoria: mientras se ordena uno, el servicio escribe el tramo
+ * anterior y lee el siguiente; ordena() puede reservar además hasta dos trozos más (las claves y el buffer de ord_parR), que
+ * también se cuentan en la memoria. En la fase 2 cada tramo tiene dos bloques (mientras se mezcla uno se lee el otro) y la salida
+ * otros dos (mientras se llena uno se escribe el otro), así que la lectura, la mezcla y la escritura se solapan.
+ *
+ * Los ficheros temporales se crean en $TMPDIR (o /tmp) y se borran nada más abrirlos: desaparecen al cerrarlos aunque el
+ * programa termine mal.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define TROZOS 5			   // La memoria se reparte en 3 trozos más los 2 de buffers que puede reservar ordena() (ord_parR)
+#define TROZO_MAX (1 << 30)	   // ordena() recibe el tamaño como int
+#define BLOQUE_MAX (1L << 20)  // Componentes de cada lectura o escritura de la mezcla (4 MB): más no acelera la E/S
+#define BLOQUE_MIN (1L << 14)  // Con bloques más pequeños (64 KB) la mezcla pasaría el tiempo esperando al disco
+
+// Una lectura o escritura de cuantos componentes en la posición (en componentes) del fichero fd
+struct peticion_es
+{
+	int fd, escribe;
+	float *buffer;
+	long cuantos, posicion;
+	long hechos;	// componentes transferidos (menos de cuantos si se acaba el fichero o hay un error)
+	int terminada;	// protegida por el cerrojo del servicio
+	struct peticion_es *siguiente;
+};
+
+struct servicio_es
+{
+	pthread_t hilo;
+	pthread_mutex_t cerrojo;
+	pthread_cond_t hay_peticiones, hay_terminadas;
+	struct peticion_es *primera, *ultima;
+	int termina;
+};
+
+// Tramo ordenado en un fichero temporal, leído por bloques con dos buffers
+struct tramo_fichero
+{
+	int fd;
+	long total, pedidos; // componentes del tramo y componentes ya pedidos al servicio
+	float *buffer[2];
+	struct peticion_es lectura[2];
+	int actual;			 // buffer que se está mezclando
+};
+
+// Transfiere la petición entera (read y write pueden hacer menos de lo pedido)
+void transfiere(struct peticion_es *p)
+{
+	char *b = (char *)p->buffer;
+	long bytes = p->cuantos * (long)sizeof(float), hechos = 0;
+	ssize_t r;
+	off_t posicion = (off_t)p->posicion * sizeof(float);
+	while (hechos < bytes)
+	{
+		r = p->escribe ? pwrite(p->fd, b + hechos, bytes - hechos, posicion + hechos)
+					   : pread(p->fd, b + hechos, bytes - hechos, posicion + hechos);
+		if (r <= 0)
+			break;
+		hechos += r;
+	}
+	p->hechos = hechos / (long)sizeof(float);
+}
+
+void *hilo_es(void *arg)
+{
+	struct servicio_es *s = (struct servicio_es *)arg;
+	struct peticion_es *p;
+	pthread_mutex_lock(&s->cerrojo);
+	for (;;)
+	{
+		while ((s->primera == NULL) && !s->termina)
+			pthread_cond_wait(&s->hay_peticiones, &s->cerrojo);
+		if (s->primera == NULL)
+			break;
+		p = s->primera;
+		s->primera = p->siguiente;
+		pthread_mutex_unlock(&s->cerrojo);
+		transfiere(p);
+		pthread_mutex_lock(&s->cerrojo);
+		p->terminada = TRUE;
+		pthread_cond_broadcast(&s->hay_terminadas);
+	}
+	pthread_mutex_unlock(&s->cerrojo);
+	return NULL;
+}
+
+int inicia_servicio(struct servicio_es *s)
+{
+	s->primera = s->ultima = NULL;
+	s->termina = FALSE;
+	pthread_mutex_init(&s->cerrojo, NULL);
+	pthread_cond_init(&s->hay_peticiones, NULL);
+	pthread_cond_init(&s->hay_terminadas, NULL);
+	return pthread_create(&s->hilo, NULL, hilo_es, s) == 0;
+}
+
+// Atiende las peticiones que queden y termina el hilo
+void termina_servicio(struct servicio_es *s)
+{
+	pthread_mutex_lock(&s->cerrojo);
+	s->termina = TRUE;
+	pthread_cond_signal(&s->hay_peticiones);
+	pthread_mutex_unlock(&s->cerrojo);
+	pthread_join(s->hilo, NULL);
+	pthread_mutex_destroy(&s->cerrojo);
+	pthread_cond_destroy(&s->hay_peticiones);
+	pthread_cond_destroy(&s->hay_terminadas);
+}
+
+// Pide una transferencia sin esperar a que termine. Con 0 componentes no se encola y queda terminada.
+void pide(struct servicio_es *s, struct peticion_es *p, int fd, int escribe, float *buffer, long cuantos, long posicion)
+{
+	p->fd = fd;
+	p->escribe = escribe;
+	p->buffer = buffer;
+	p->cuantos = cuantos;
+	p->posicion = posicion;
+	p->hechos = 0;
+	p->siguiente = NULL;
+	p->terminada = (cuantos == 0);
+	if (cuantos == 0)
+		return;
+	pthread_mutex_lock(&s->cerrojo);
+	if (s->primera == NULL)
+		s->primera = p;
+	else
+		s->ultima->siguiente = p;
+	s->ultima = p;
+	pthread_cond_signal(&s->hay_peticiones);
+	pthread_mutex_unlock(&s->cerrojo);
+}
+
+// Espera a que termine la petición. Devuelve FALSE si no se ha podido transferir entera.
+int espera(struct servicio_es *s, struct peticion_es *p)
+{
+	pthread_mutex_lock(&s->cerrojo);
+	while (!p->terminada)
+		pthread_cond_wait(&s->hay_terminadas, &s->cerrojo);
+	pthread_mutex_unlock(&s->cerrojo);
+	return p->hechos == p->cuantos;
+}
+
+// Fichero temporal ya borrado del directorio, o -1
+int temporal(void)
+{
+	char ruta[4096];
+	const char *dir = getenv("TMPDIR");
+	int fd;
+	snprintf(ruta, sizeof(ruta), "%s/ordena_tramoXXXXXX", ((dir != NULL) && (*dir != '\0')) ? dir : "/tmp");
+	if ((fd = mkstemp(ruta)) >= 0)
+		unlink(ruta);
+	return fd;
+}
+
+// Pide el siguiente bloque del tramo en su buffer b
+void pide_bloque(struct servicio_es *s, struct tramo_fichero *tr, int b, long bloque)
+{
+	long cuantos = min(bloque, tr->total - tr->pedidos);
+	pide(s, &tr->lectura[b], tr->fd, FALSE, tr->buffer[b], cuantos, tr->pedidos);
+	tr->pedidos += cuantos;
+}
+
+/* Fase 1: ordena el fichero fd_entrada (n componentes) por trozos de como mucho trozo componentes y escribe cada uno en
+ * fds[r] (el tramo r). Devuelve FALSE si falla la E/S.
+ */
+int ordena_trozos(struct servicio_es *s, int fd_entrada, long n, long trozo, int ntramos, int fds[], float *buffer[3])
+{
+	struct peticion_es lectura[3], escritura[3];
+	int r, b, correcto = TRUE;
+	long cuantos;
+
+	for (b = 0; b < 3; b++)
+		pide(s, &escritura[b], -1, TRUE, NULL, 0, 0);
+	pide(s, &lectura[0], fd_entrada, FALSE, buffer[0], min(trozo, n), 0);
+	for (r = 0; r < ntramos; r++)
+	{
+		b = r % 3;
+		correcto &= espera(s, &lectura[b]);
+		if (r + 1 < ntramos)
+		{ // El buffer del trozo siguiente es el del tramo r-2: su escritura ya tiene que haber terminado
+			correcto &= espera(s, &escritura[(r + 1) % 3]);
+			pide(s, &lectura[(r + 1) % 3], fd_entrada, FALSE, buffer[(r + 1) % 3], min(trozo, n - (r + 1) * trozo), (r + 1) * trozo);
+		}
+		cuantos = lectura[b].cuantos;
+		ordena(buffer[b], (int)cuantos);
+		pide(s, &escritura[b], fds[r], TRUE, buffer[b], cuantos, 0);
+	}
+	for (b = 0; b < 3; b++)
+		correcto &= espera(s, &escritura[b]);
+	return correcto;
+}
+
+/* Fase 2: mezcla los ntramos tramos (fds[r], con longitudes[r] componentes desde el principio del fichero) en fd_salida con
+ * bloques de bloque componentes. memoria tiene sitio para (2 * ntramos + 2) bloques.
+ */
+int mezcla_tramos(struct servicio_es *s, int fd_salida, int ntramos, const int fds[], const long longitudes[], float *memoria,
+				  long bloque)
+{
+	struct tramo_fichero *tramos = (struct tramo_fichero *)malloc(ntramos * sizeof(struct tramo_fichero));
+	struct peticion_es escritura[2];
+	struct torneo t;
+	float *salida[2] = {memoria, memoria + bloque};
+	int r, f, sb = 0, correcto = TRUE;
+	long o = 0, escritos = 0, n = 0;
+
+	if ((tramos == NULL) || !creaTorneo(&t, ntramos))
+	{
+		free(tramos);
+		return FALSE;
+	}
+	for (r = 0; r < ntramos; r++)
+	{
+		tramos[r].fd = fds[r];
+		tramos[r].total = longitudes[r];
+		n += longitudes[r];
+		tramos[r].pedidos = 0;
+		tramos[r].buffer[0] = memoria + (2 + 2 * (long)r) * bloque;
+		tramos[r].buffer[1] = tramos[r].buffer[0] + bloque;
+		tramos[r].actual = 0;
+		pide_bloque(s, &tramos[r], 0, bloque);
+		pide_bloque(s, &tramos[r], 1, bloque);
+	}
+	for (r = 0; r < ntramos; r++)
+	{
+		correcto &= espera(s, &tramos[r].lectura[0]);
+		fuenteTorneo(&t, r, tramos[r].buffer[0], tramos[r].lectura[0].hechos, tramos[r].pedidos == tramos[r].lectura[0].cuantos);
+	}
+	iniciaTorneo(&t);
+	pide(s, &escritura[0], -1, TRUE, NULL, 0, 0);
+	pide(s, &escritura[1], -1, TRUE, NULL, 0, 0);
+
+	while (correcto)
+	{
+		o += mezclaTorneo(&t, salida[sb] + o, bloque - o);
+		if (o == bloque)
+		{ // Write-behind: se escribe este buffer mientras se llena el otro
+			pide(s, &escritura[sb], fd_salida, TRUE, salida[sb], o, escritos);
+			escritos += o;
+			o = 0;
+			sb ^= 1;
+			correcto &= espera(s, &escritura[sb]);
+		}
+		else if ((f = t.pendiente) >= 0)
+		{ // Read-ahead: el otro buffer del tramo ya está pedido; el que se acaba de vaciar se pide para el bloque siguiente
+			struct tramo_fichero *tr = &tramos[f];
+			int vaciado = tr->actual;
+			tr->actual ^= 1;
+			correcto &= espera(s, &tr->lectura[tr->actual]);
+			pide_bloque(s, tr, vaciado, bloque);
+			fuenteTorneo(&t, f, tr->buffer[tr->actual], tr->lectura[tr->actual].hechos,
+						 tr->lectura[vaciado].cuantos == 0); // el último si ya no queda nada por pedir
+		}
+		else
+			break;
+	}
+	pide(s, &escritura[sb], fd_salida, TRUE, salida[sb], o, escritos);
+	escritos += o;
+	correcto &= espera(s, &escritura[0]);
+	correcto &= espera(s, &escritura[1]);
+	for (r = 0; r < ntramos; r++)
+	{ // Si algo ha fallado puede haber lecturas en vuelo que usan los buffers
+		espera(s, &tramos[r].lectura[0]);
+		espera(s, &tramos[r].lectura[1]);
+	}
+
+	liberaTorneo(&t);
+	free(tramos);
+	return correcto && (escritos == n);
+}
+
+/* Pasadas intermedias de la fase 2: mientras haya más de vias tramos, los mezcla por grupos de vias en tramos nuevos (en
+ * ficheros temporales). Cierra los ficheros de los tramos que mezcla y deja en fds, longitudes y *ntramos los que quedan.
+ * Devuelve el n.º de pasadas o -1 si falla la E/S (los ficheros que quedan abiertos siguen en fds y los demás a -1).
+ */
+int reduce_tramos(struct servicio_es *s, int *ntramos, int fds[], long longitudes[], int vias, float *memoria, long bloque)
+{
+	int g, r, k, ngrupos, pasadas = 0;
+	long total;
+
+	for (; *ntramos > vias; pasadas++)
+	{
+		ngrupos = (*ntramos + vias - 1) / vias;
+		for (g = 0; g < ngrupos; g++)
+		{ // El grupo g escribe su tramo en fds[g], que ya está libre (g <= g * vias)
+			int ini = g * vias, fd;
+			k = min(vias, *ntramos - ini);
+			if (k == 1)
+			{ // El último grupo es un solo tramo: pasa tal cual
+				fds[g] = fds[ini];
+				longitudes[g] = longitudes[ini];
+				if (g != ini)
+					fds[ini] = -1;
+				continue;
+			}
+			fd = temporal();
+			for (total = 0, r = ini; r < ini + k; r++)
+				total += longitudes[r];
+			if ((fd < 0) || !mezcla_tramos(s, fd, k, fds + ini, longitudes + ini, memoria, bloque))
+			{
+				if (fd >= 0)
+					close(fd);
+				return -1;
+			}
+			for (r = ini; r < ini + k; r++)
+			{
+				close(fds[r]);
+				fds[r] = -1;
+			}
+			fds[g] = fd;
+			longitudes[g] = total;
+		}
+		*ntramos = ngrupos;
+	}
+	return pasadas;
+}
+
+/* Ordena el fichero de floats entrada y deja el resultado en salida (pueden ser el mismo) usando como mucho unos memoria
+ * bytes. Si res no es NULL deja ahí los componentes, los tramos, las pasadas intermedias de la mezcla y el tiempo de cada
+ * fase. Devuelve FALSE si no puede leer o escribir los ficheros, si no hay memoria o si la memoria no da ni para mezclar dos
+ * tramos con bloques de BLOQUE_MIN componentes.
+ */
+int ordenaFichero(const char *entrada, const char *salida, long memoria, struct resumen_externo *res)
+{
+	struct servicio_es s;
+	struct stat info;
+	int r, ntramos, vias, pasadas = 0, fd_entrada, fd_salida = -1, *fds = NULL, correcto = FALSE;
+	long n, trozo, bloque, *longitudes = NULL;
+	float *buffer = NULL, *trozos[3];
+	double t0 = omp_get_wtime(), t1;
+
+	if ((fd_entrada = open(entrada, O_RDONLY)) < 0)
+		return FALSE;
+	if ((fstat(fd_entrada, &info) != 0) || (info.st_size % sizeof(float) != 0))
+	{
+		close(fd_entrada);
+		return FALSE;
+	}
+	n = info.st_size / sizeof(float);
+	trozo = min(max(memoria / TROZOS / (long)sizeof(float), BLOQUE_MIN), TROZO_MAX);
+	ntramos = (n == 0) ? 0 : (int)((n - 1) / trozo + 1);
+	// Tramos que caben en una mezcla con bloques de BLOQUE_MIN componentes (cada uno lleva dos bloques y la salida otros dos)
+	vias = (int)min((memoria / (long)sizeof(float) / BLOQUE_MIN - 2) / 2, (long)ntramos);
+	bloque = (ntramos > 1) ? min(memoria / (2 * (long)vias + 2) / (long)sizeof(float), BLOQUE_MAX) : 0;
+	if ((ntramos > 1) && (vias < 2))
+	{
+		close(fd_entrada);
+		return FALSE;
+	}
+	if (ntramos == 1)
+		trozo = n; // Basta un trozo justo del tamaño del fichero
+
+	// Un solo buffer para los 3 trozos de la fase 1, que luego se reparte en los bloques de la fase 2
+	buffer = (float *)reservaAlineada(max(3 * trozo, (2 * (long)vias + 2) * bloque) * (long)sizeof(float));
+	fds = (int *)malloc((ntramos + 1) * sizeof(int));
+	longitudes = (long *)malloc((ntramos + 1) * sizeof(long));
+	if ((buffer == NULL) || (fds == NULL) || (longitudes == NULL) || !inicia_servicio(&s))
+	{
+		liberaAlineada(buffer);
+		free(fds);
+		free(longitudes);
+		close(fd_entrada);
+		return FALSE;
+	}
+	for (r = 0; r < 3; r++)
+		trozos[r] = buffer + r * trozo;
+
+	/* Con un solo trozo se ordena y se escribe directamente en la salida (si es la misma que la entrada, sin truncarla: se
+	 * reescribe con el mismo tamaño). Con varios, la salida se abre después de la fase 1, cuando ya se ha leído la entrada.
+	 */
+	correcto = TRUE;
+	for (r = 0; r < ntramos; r++)
+	{
+		fds[r] = -1;
+		longitudes[r] = min(trozo, n - r * trozo);
+	}
+	if (ntramos <= 1)
+		correcto = ((fds[0] = fd_salida = open(salida, (strcmp(entrada, salida) != 0) ? O_WRONLY | O_CREAT | O_TRUNC : O_WRONLY, 0644)) >= 0);
+	else
+		for (r = 0; r < ntramos; r++)
+			correcto &= ((fds[r] = temporal()) >= 0);
+	if (correcto)
+		correcto = ordena_trozos(&s, fd_entrada, n, trozo, ntramos, fds, trozos);
+	t1 = omp_get_wtime();
+	r = ntramos; // Los tramos abiertos están siempre entre los r primeros de fds
+	if (correcto && (ntramos > 1))
+		correcto = ((pasadas = reduce_tramos(&s, &ntramos, fds, longitudes, vias, buffer, bloque)) >= 0) &&
+				   ((fd_salida = open(salida, O_WRONLY | O_CREAT | O_TRUNC, 0644)) >= 0) &&
+				   mezcla_tramos(&s, fd_salida, ntramos, fds, longitudes, buffer, bloque);
+
+	termina_servicio(&s);
+	if (r > 1)
+		while (r-- > 0)
+			if (fds[r] >= 0)
+				close(fds[r]);
+	if (fd_salida >= 0)
+		close(fd_salida);
+	close(fd_entrada);
+	liberaAlineada(buffer);
+	free(fds);
+	free(longitudes);
+	if (res != NULL)
+	{
+		res->componentes = n;
+		res->tramos = (n == 0) ? 0 : (int)((n - 1) / trozo + 1);
+		res->pasadas = max(pasadas, 0);
+		res->bloque = bloque;
+		res->t_tramos = t1 - t0;
+		res->t_mezcla = omp_get_wtime() - t1;
+	}
+	return correcto;
+}
+
+/* Recorre el fichero de floats por bloques: deja en n los componentes y en huella una suma de un hash de cada componente,
+ * que no depende del orden (sirve para comprobar que la salida tiene los mismos componentes que la entrada). Devuelve la
+ * posición del primer componente mayor que el siguiente, -1 si está ordenado o -2 si no se puede leer.
+ */
+long compruebaFichero(const char *fichero, long *n, uint64_t *huella)
+{
+	FILE *f = fopen(fichero, "rb");
+	float *b = (float *)malloc(BLOQUE_MAX * sizeof(float)), anterior = 0;
+	long leidos, i, total = 0, desorden = -1;
+	uint32_t bits;
+
+	*n = 0;
+	*huella = 0;
+	if ((f == NULL) || (b == NULL))
+	{
+		if (f != NULL)
+			fclose(f);
+		free(b);
+		return -2;
+	}
+	while ((leidos = (long)fread(b, sizeof(float), BLOQUE_MAX, f)) > 0)
+	{
+		for (i = 0; i < leidos; i++)
+		{
+			if ((desorden < 0) && (total + i > 0) && (b[i] < anterior))
+				desorden = total + i - 1;
+			anterior = b[i];
+			memcpy(&bits, &b[i], sizeof(bits));
+			*huella += mezcla64(bits);
+		}
+		total += leidos;
+	}
+	fclose(f);
+	free(b);
+	*n = total;
+	return desorden;
+}
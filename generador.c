@@ -0,0 +1,176 @@
+/* Ordenación de un vector: generación de los vectores de entrada
+ *
+ * Cada componente se calcula a partir de la semilla y de su posición (generador basado en contador), sin estado compartido
+ * entre componentes. Así el vector se rellena en paralelo y sale igual con cualquier n.º de hilos para la misma semilla.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define CASI_POR_DEFECTO 100	// Casi ordenado: por defecto se hace un intercambio por cada CASI_POR_DEFECTO componentes
+#define POCOS_POR_DEFECTO 16	// Pocos valores distintos: cuántos, por defecto
+#define ZIPF_POR_DEFECTO 1000	// Zipf: n.º de valores distintos por defecto
+#define CEROS_POR_DEFECTO 100	// Ceros: por defecto, un NaN por cada CEROS_POR_DEFECTO componentes
+#define DOS_PI 6.283185307179586
+
+// Mismo orden que las constantes DIST_* de ordena.h
+const char *distribuciones[] = {"uniforme", "ordenado", "inverso", "casi", "pocos", "iguales", "zipf", "gauss", "organo", "ceros"};
+const int ndistribuciones = sizeof(distribuciones) / sizeof(distribuciones[0]);
+
+// Índice de la distribución con ese nombre o -1 si no existe
+int buscaDistribucion(const char *nombre)
+{
+	int d;
+	for (d = 0; (d < ndistribuciones) && strcmp(distribuciones[d], nombre); d++)
+		;
+	return (d < ndistribuciones) ? d : -1;
+}
+
+// Función de mezcla de splitmix64: biyectiva y con buen efecto avalancha (cada bit de entrada cambia la mitad de los de salida)
+uint64_t mezcla64(uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+/* Número pseudoaleatorio i-ésimo del flujo "flujo" de una semilla. Es splitmix64 sin estado: el contador i avanza la constante
+ * de Weyl y el flujo cambia el origen, de modo que distintas variables del mismo componente (por ejemplo, las dos uniformes de
+ * Box-Muller) salen de flujos independientes.
+ */
+uint64_t aleatorio64(unsigned semilla, unsigned flujo, uint64_t i)
+{
+	uint64_t origen = mezcla64(((uint64_t)semilla << 32) ^ flujo);
+	return mezcla64(origen + (i + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+// Uniforme en [0, 1[ con los 53 bits altos
+double uniforme01(uint64_t x)
+{
+	return (x >> 11) * 0x1.0p-53;
+}
+
+/* Rellena vector con size componentes de la distribución indicada, escalados al intervalo [0, rango[:
+ *  - uniforme: independientes y uniformes en [0, rango[
+ *  - ordenado / inverso: rectas creciente / decreciente
+ *  - casi: ordenado con parametro intercambios entre posiciones al azar (por defecto size/CASI_POR_DEFECTO)
+ *  - pocos: parametro valores distintos equiprobables (por defecto POCOS_POR_DEFECTO)
+ *  - iguales: todos los componentes valen rango/2
+ *  - zipf: parametro valores distintos (por defecto ZIPF_POR_DEFECTO), el de rango r con probabilidad proporcional a 1/r; los
+ *    valores se reparten por el intervalo para que el más frecuente no sea siempre el menor
+ *  - gauss: normal de media rango/2 y desviación rango/6 (sin recortar: alrededor del 0,3 % cae fuera del intervalo)
+ *  - organo: tubos de órgano, creciente hasta la mitad y decreciente después
+ *  - ceros: +0 y -0 al azar y un NaN de cada parametro componentes (por defecto CEROS_POR_DEFECTO; negativo, sin NaN). No
+ *    depende del rango: sirve para comprobar que los métodos devuelven una permutación de la entrada con valores que < no
+ *    distingue (+0 y -0) o no ordena (NaN)
+ * Los intercambios de "casi" se aplican en orden en un solo hilo (dos pueden tocar la misma posición), pero son pocos.
+ * Devuelve FALSE si no hay memoria para la tabla de zipf (parametro doubles); vector queda entonces sin rellenar.
+ */
+int generaVector(float vector[], int size, int distribucion, int rango, unsigned semilla, long parametro)
+{
+	int i;
+	long j, k;
+	double *acumulada;
+	float tope = nextafterf((float)rango, 0); // mayor float del intervalo [0, rango[
+
+	switch (distribucion)
+	{
+	case DIST_UNIFORME:
+		// Al redondear a float, un u muy cerca de 1 puede dar justo rango: se deja en el mayor float por debajo
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			vector[i] = fminf((float)(rango * uniforme01(aleatorio64(semilla, 0, i))), tope);
+		break;
+	case DIST_ORDENADO:
+	case DIST_CASI:
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			vector[i] = (float)((double)rango * i / size);
+		if (distribucion == DIST_CASI)
+		{
+			k = (parametro > 0) ? parametro : size / CASI_POR_DEFECTO;
+			for (j = 0; (j < k) && (size > 1); j++)
+			{
+				int a = aleatorio64(semilla, 1, 2 * j) % size, b = aleatorio64(semilla, 1, 2 * j + 1) % size;
+				float temp = vector[a];
+				vector[a] = vector[b];
+				vector[b] = temp;
+			}
+		}
+		break;
+	case DIST_INVERSO:
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			vector[i] = (float)((double)rango * (size - 1 - i) / size);
+		break;
+	case DIST_POCOS:
+		k = (parametro > 0) ? parametro : POCOS_POR_DEFECTO;
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			vector[i] = (float)((double)rango * (aleatorio64(semilla, 0, i) % k) / k);
+		break;
+	case DIST_IGUALES:
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			vector[i] = rango / 2.0f;
+		break;
+	case DIST_ZIPF:
+		// Inversa de la función de distribución: búsqueda binaria en la tabla de probabilidades acumuladas
+		k = (parametro > 0) ? parametro : ZIPF_POR_DEFECTO;
+		if ((acumulada = (double *)malloc(k * sizeof(double))) == NULL)
+			return FALSE;
+		acumulada[0] = 1;
+		for (j = 1; j < k; j++)
+			acumulada[j] = acumulada[j - 1] + 1.0 / (j + 1);
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+		{
+			double u = uniforme01(aleatorio64(semilla, 0, i)) * acumulada[k - 1];
+			long izq = 0, der = k - 1, med;
+			while (izq < der)
+			{
+				med = (izq + der) / 2;
+				if (acumulada[med] <= u)
+					izq = med + 1;
+				else
+					der = med;
+			}
+			// 2654435761 es primo, así que multiplicar por él módulo k es una permutación de los k valores
+			vector[i] = (float)((double)rango * ((uint64_t)izq * 2654435761ULL % k) / k);
+		}
+		free(acumulada);
+		break;
+	case DIST_GAUSS:
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+		{ // Box-Muller: u1 en ]0, 1] para que el logaritmo sea finito
+			double u1 = 1 - uniforme01(aleatorio64(semilla, 0, i)), u2 = uniforme01(aleatorio64(semilla, 1, i));
+			vector[i] = (float)(rango / 2.0 + rango / 6.0 * sqrt(-2 * log(u1)) * cos(DOS_PI * u2));
+		}
+		break;
+	case DIST_ORGANO:
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+			vector[i] = (float)((double)rango * min(i, size - 1 - i) / ((size + 1) / 2));
+		break;
+	case DIST_CEROS:
+		k = (parametro != 0) ? parametro : CEROS_POR_DEFECTO;
+		#pragma omp parallel for schedule(static)
+		for (i = 0; i < size; i++)
+		{
+			uint64_t x = aleatorio64(semilla, 0, i);
+			vector[i] = ((k > 0) && (x % k == 0)) ? NAN : ((x >> 32) & 1) ? 0.0f : -0.0f;
+		}
+		break;
+	}
+	return TRUE;
+}
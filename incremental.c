@@ -0,0 +1,133 @@
+/* Ordenación de un vector: vector ordenado incremental (inserción por lotes)
+ *
+ * Un vector_ordenado guarda sus n componentes ordenados al principio de un buffer de capacidad mayor: el final libre es el
+ * hueco en el que crece. insertaLote copia el lote en un buffer propio, lo ordena en paralelo con ordena() y lo mezcla con
+ * lo que ya había, en O(n + b log b) en lugar de volver a ordenarlo todo (o de insertar uno a uno, como ord_parB):
+ *  - Con lotes pequeños frente a n, la mezcla es hacia atrás y en el sitio: del último componente del lote al primero, se
+ *    busca (galope desde el final) cuántos de los que ya había van detrás de él, se desplazan de una vez con memmove hasta
+ *    su sitio definitivo y se coloca el componente del lote delante. Cada componente se mueve una sola vez y, como se
+ *    escribe de atrás hacia delante, nunca se pisa uno que todavía no se ha leído.
+ *  - Con lotes grandes (al menos n/LOTE_TRAMO componentes) los trozos que se desplazan son tan cortos que la mezcla hacia
+ *    atrás es una mezcla componente a componente en un hilo; en ese caso se mezcla con mezcla_paralela (merge path y
+ *    mezcla vectorizada) en un segundo buffer de la misma capacidad, que pasa a ser el de los datos. Ese buffer se reserva
+ *    la primera vez que hace falta; si no hay memoria se mezcla hacia atrás.
+ * La mezcla es estable: con iguales, los que ya estaban van delante de los del lote.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "ordena.h"
+
+#define LOTE_TRAMO 64 // Con lotes de n/LOTE_TRAMO componentes o más, mezcla en paralelo en el buffer de reserva
+
+int creaOrdenado(struct vector_ordenado *o, int capacidad)
+{
+	o->n = 0;
+	o->capacidad = max(capacidad, 1);
+	o->capacidad_lote = 0;
+	o->datos = reservaVector(o->capacidad);
+	o->reserva = o->lote = NULL;
+	return o->datos != NULL;
+}
+
+void liberaOrdenado(struct vector_ordenado *o)
+{
+	liberaAlineada(o->datos);
+	liberaAlineada(o->reserva);
+	liberaAlineada(o->lote);
+	o->datos = o->reserva = o->lote = NULL;
+	o->n = o->capacidad = o->capacidad_lote = 0;
+}
+
+// Galope desde el final: primera posición p de v[0..n) (ordenado) con v[p..n) > x
+int galope_atras(float x, const float v[], int n)
+{
+	int lo = n - 1, hi = n, salto = 1, med;
+	while ((lo >= 0) && (v[lo] > x))
+	{
+		hi = lo;
+		lo = n - (salto *= 2);
+	}
+	lo = max(lo + 1, 0); // la respuesta está en [lo, hi]
+	while (lo < hi)
+	{
+		med = lo + (hi - lo) / 2;
+		if (v[med] <= x)
+			lo = med + 1;
+		else
+			hi = med;
+	}
+	return lo;
+}
+
+// Mezcla hacia atrás, en el sitio, del lote ordenado b[0..nb) con datos[0..n), dejando el resultado en datos[0..n+nb)
+void mezcla_atras(float datos[], int n, const float b[], int nb)
+{
+	int j, p;
+	for (j = nb - 1; j >= 0; j--)
+	{
+		p = galope_atras(b[j], datos, n);
+		memmove(datos + p + j + 1, datos + p, (n - p) * sizeof(float));
+		datos[p + j] = b[j];
+		n = p;
+	}
+}
+
+// Cambia la capacidad del vector (conservando los datos); el buffer de reserva se vuelve a reservar cuando haga falta
+int redimensiona(struct vector_ordenado *o, int capacidad)
+{
+	float *nuevo = reservaVector(capacidad);
+	if (nuevo == NULL)
+		return FALSE;
+	copiarVector(nuevo, o->datos, o->n);
+	liberaAlineada(o->datos);
+	liberaAlineada(o->reserva);
+	o->datos = nuevo;
+	o->reserva = NULL;
+	o->capacidad = capacidad;
+	return TRUE;
+}
+
+int insertaLote(struct vector_ordenado *o, const float lote[], int size)
+{
+	float *temp;
+	long total = (long)o->n + size;
+	int paralela = (o->n > 0) && ((long)size * LOTE_TRAMO >= o->n);
+
+	if (size <= 0)
+		return TRUE;
+	if ((total > INT_MAX) ||
+		((total > o->capacidad) && !redimensiona(o, (int)min(max(2L * o->capacidad, total), (long)INT_MAX))))
+		return FALSE;
+	if (size > o->capacidad_lote)
+	{ // El lote se ordena en un buffer propio, que se conserva para los siguientes
+		liberaAlineada(o->lote);
+		o->capacidad_lote = 0;
+		if ((o->lote = reservaVector(size)) == NULL)
+			return FALSE;
+		o->capacidad_lote = size;
+	}
+	copiarVector(o->lote, (float *)lote, size);
+	ordena(o->lote, size);
+
+	if (paralela && (o->reserva == NULL))
+		o->reserva = reservaVector(o->capacidad);
+	if (paralela && (o->reserva != NULL))
+	{
+		mezcla_paralela(o->datos, o->n, o->lote, size, o->reserva);
+		temp = o->datos;
+		o->datos = o->reserva;
+		o->reserva = temp;
+	}
+	else
+		mezcla_atras(o->datos, o->n, o->lote, size);
+	o->n = (int)total;
+	return TRUE;
+}
@@ -0,0 +1,188 @@
+/* Ordenación de un vector: recogida de los datos de la instrumentación (ver instrumentacion.h)
+ *
+ * Sin -DINSTRUMENTAR este fichero no genera código.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include "ordena.h"
+#include "instrumentacion.h"
+
+#ifdef INSTRUMENTAR
+#include <stdint.h>
+#include <string.h>
+#include <omp.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define INS_EVENTOS 3
+
+_Thread_local struct ins_hilo ins_local;
+struct ins_hilo *ins_hilos[INS_MAX_HILOS]; // contadores de cada hilo en la medida actual (NULL si no ha contado nada)
+int ins_generacion = 1; // cambia en cada ins_reinicia; los contadores de generaciones anteriores no están en ins_hilos
+double ins_regiones = 0;
+double ins_pasadas[INS_MAX_PASADAS];
+int ins_npasadas = 0; // mayor n.º de pasada anotada + 1
+
+const char *ins_nombres[INS_EVENTOS] = {"ciclos", "fallos de LLC", "fallos de predicción de saltos"};
+int ins_fd[INS_EVENTOS] = {-1, -1, -1};
+
+/* Abre los contadores hardware para todo el proceso. Tiene que llamarse antes de la primera región paralela: con inherit
+ * los contadores incluyen los hilos que se creen después (los de OpenMP), pero no los que ya existen.
+ */
+void ins_abre(void)
+{
+#ifdef __linux__
+	const uint64_t eventos[INS_EVENTOS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+	struct perf_event_attr atributos;
+	int e;
+	for (e = 0; e < INS_EVENTOS; e++)
+	{
+		memset(&atributos, 0, sizeof(atributos));
+		atributos.type = PERF_TYPE_HARDWARE;
+		atributos.size = sizeof(atributos);
+		atributos.config = eventos[e];
+		atributos.disabled = 1;
+		atributos.inherit = 1;
+		atributos.exclude_kernel = 1;
+		atributos.exclude_hv = 1;
+		ins_fd[e] = (int)syscall(__NR_perf_event_open, &atributos, 0, -1, -1, 0); // -1 si no está disponible
+	}
+#endif
+}
+
+/* Primer contador que toca un hilo en la medida actual: pone los suyos a cero y los apunta en el hueco de su n.º de hilo en
+ * el equipo más externo (dentro de una región anidada el n.º de hilo es 0 para todos). Si ese hueco ya está ocupado (un hilo
+ * que no es de OpenMP, como los del ejecutor de robo, que son todos el 0), en el primero libre que le siga.
+ */
+struct ins_hilo *ins_apunta(void)
+{
+	struct ins_hilo *libre;
+	int h = omp_get_ancestor_thread_num(1);
+
+	memset(&ins_local, 0, sizeof(ins_local));
+	ins_local.generacion = ins_generacion;
+	for (h = (h < 0) ? 0 : h; h < INS_MAX_HILOS; h++)
+	{
+		libre = NULL;
+		if (__atomic_compare_exchange_n(&ins_hilos[h], &libre, &ins_local, FALSE, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			break;
+	}
+	return &ins_local; // Sin hueco (más de INS_MAX_HILOS hilos) sigue contando, pero no sale en el informe
+}
+
+/* Pone a cero todo lo acumulado. Los contadores de cada hilo no se tocan aquí: con la nueva generación, cada hilo pone los
+ * suyos a cero y se vuelve a apuntar la próxima vez que cuente algo. Se llama fuera de las regiones paralelas, así que la
+ * siguiente región ya ve la nueva generación.
+ */
+void ins_reinicia(void)
+{
+	int e;
+	ins_generacion++;
+	memset(ins_hilos, 0, sizeof(ins_hilos));
+	ins_regiones = 0;
+	ins_npasadas = 0;
+	memset(ins_pasadas, 0, sizeof(ins_pasadas));
+	for (e = 0; e < INS_EVENTOS; e++)
+		if (ins_fd[e] >= 0)
+			ioctl(ins_fd[e], PERF_EVENT_IOC_RESET, 0);
+}
+
+// Activa o para los contadores hardware (solo se cuenta la ordenación, no la copia del vector entre repeticiones)
+void ins_mide(int activo)
+{
+	int e;
+	for (e = 0; e < INS_EVENTOS; e++)
+		if (ins_fd[e] >= 0)
+			ioctl(ins_fd[e], activo ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+}
+
+// Una pasada (nivel) también cuenta como tiempo de región paralela
+void ins_pasada(int pasada, double tiempo)
+{
+	if ((pasada >= 0) && (pasada < INS_MAX_PASADAS))
+	{
+		ins_pasadas[pasada] += tiempo;
+		if (pasada >= ins_npasadas)
+			ins_npasadas = pasada + 1;
+	}
+	ins_regiones += tiempo;
+}
+
+/* Se llama después de la medida, desde el hilo principal: lee los contadores que cada hilo apuntó en ins_hilos (los hilos de
+ * OpenMP siguen vivos y sus contadores no cambian fuera de las regiones). Los huecos vacíos son hilos que no han contado nada.
+ */
+void ins_informe(FILE *f, const char *metodo, int repeticiones)
+{
+	struct ins_hilo hilos[INS_MAX_HILOS];
+	int h, e, nhilos = omp_get_max_threads(), perf = FALSE;
+	long comparaciones = 0, movimientos = 0;
+	uint64_t valor[INS_EVENTOS];
+
+	for (h = 0; h < INS_MAX_HILOS; h++)
+	{
+		struct ins_hilo *apuntado = __atomic_load_n(&ins_hilos[h], __ATOMIC_ACQUIRE);
+		if (apuntado != NULL)
+		{
+			hilos[h] = *apuntado;
+			if (h >= nhilos)
+				nhilos = h + 1;
+		}
+		else
+			memset(&hilos[h], 0, sizeof(hilos[h]));
+	}
+	if (nhilos > INS_MAX_HILOS)
+		nhilos = INS_MAX_HILOS;
+	for (h = 0; h < nhilos; h++)
+	{
+		comparaciones += hilos[h].comparaciones;
+		movimientos += hilos[h].movimientos;
+	}
+	for (e = 0; e < INS_EVENTOS; e++)
+		if ((ins_fd[e] >= 0) && (read(ins_fd[e], &valor[e], sizeof(valor[e])) == sizeof(valor[e])))
+			perf = TRUE;
+		else
+			valor[e] = UINT64_MAX;
+
+	fprintf(f, "Instrumentación de %s (media de %d repeticiones):\n", metodo, repeticiones);
+	if ((ins_regiones == 0) && (comparaciones == 0) && (movimientos == 0))
+		fprintf(f, "  Método sin instrumentar: solo hay contadores hardware\n");
+	else
+	{
+		fprintf(f, "  Regiones paralelas instrumentadas: %0.6f ms\n", 1000 * ins_regiones / repeticiones);
+		if (ins_npasadas > 0)
+		{
+			fprintf(f, "  Pasadas (ms):");
+			for (h = 0; h < ins_npasadas; h++)
+				fprintf(f, " %0.6f", 1000 * ins_pasadas[h] / repeticiones);
+			fprintf(f, "\n");
+		}
+		fprintf(f, "  %5s %14s %14s %14s %16s %16s\n", "hilo", "ocupado (ms)", "barreras (ms)", "ocioso (ms)", "comparaciones", "movimientos");
+		for (h = 0; h < nhilos; h++)
+		{
+			double ocioso = ins_regiones - hilos[h].ocupado - hilos[h].espera;
+			fprintf(f, "  %5d %14.6f %14.6f %14.6f %16ld %16ld\n", h, 1000 * hilos[h].ocupado / repeticiones,
+					1000 * hilos[h].espera / repeticiones, (ocioso > 0) ? 1000 * ocioso / repeticiones : 0,
+					hilos[h].comparaciones / repeticiones, hilos[h].movimientos / repeticiones);
+		}
+		fprintf(f, "  Total: %ld comparaciones, %ld movimientos\n", comparaciones / repeticiones, movimientos / repeticiones);
+	}
+	if (!perf)
+		fprintf(f, "  Contadores hardware no disponibles (perf_event_open)\n");
+	else
+		for (e = 0; e < INS_EVENTOS; e++)
+			if (valor[e] != UINT64_MAX)
+				fprintf(f, "  %s: %llu\n", ins_nombres[e], (unsigned long long)(valor[e] / repeticiones));
+}
+
+#else
+typedef int instrumentacion_desactivada; // ISO C no admite un fichero sin declaraciones
+#endif
@@ -0,0 +1,86 @@
+/* Ordenación de un vector: instrumentación opcional de los métodos
+ *
+ * Solo existe si se compila con -DINSTRUMENTAR. Sin esa opción todas las macros de este fichero se quedan en nada (o en la
+ * misma barrera que había sin instrumentar), así que el código medido es exactamente el de siempre.
+ *
+ * Con INSTRUMENTAR, cada hilo acumula en variables propias (_Thread_local, sin sincronización en el camino caliente):
+ *  - comparaciones y movimientos de componentes
+ *  - tiempo ocupado (trabajando dentro de una región paralela) y tiempo esperando en barreras
+ * La primera vez que las toca tras INS_REINICIA, cada hilo las pone a cero y apunta dónde están en ins_hilos, en el hueco de
+ * su n.º de hilo; al final de la medida INS_INFORME lee ese vector, sin volver a entrar en los hilos.
+ * y el hilo principal acumula el tiempo de pared de las regiones paralelas instrumentadas y el de cada pasada (niveles de
+ * ord_parA y ord_parAm). El tiempo ocioso de un hilo es el de las regiones menos el ocupado y el de espera: el desequilibrio
+ * de carga y el coste de abrir y cerrar las regiones. En Linux se leen además contadores hardware con perf_event_open.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+#ifdef INSTRUMENTAR
+#include <stdio.h>
+#include <omp.h>
+
+#define INS_MAX_HILOS 256
+#define INS_MAX_PASADAS 64
+
+struct ins_hilo
+{
+	long comparaciones, movimientos;
+	double ocupado, espera; // segundos
+	int generacion;			// la de ins_generacion cuando se apuntó en ins_hilos
+};
+extern _Thread_local struct ins_hilo ins_local;
+extern struct ins_hilo *ins_hilos[INS_MAX_HILOS];
+extern int ins_generacion;
+extern double ins_regiones;
+extern double ins_pasadas[INS_MAX_PASADAS];
+
+void ins_abre(void);
+struct ins_hilo *ins_apunta(void);
+void ins_reinicia(void);
+void ins_mide(int activo);
+void ins_pasada(int pasada, double tiempo);
+void ins_informe(FILE *f, const char *metodo, int repeticiones);
+
+#define INS_LOCAL ((ins_local.generacion == ins_generacion) ? &ins_local : ins_apunta())
+#define INS_COMPARA(n) (INS_LOCAL->comparaciones += (n))
+#define INS_MUEVE(n) (INS_LOCAL->movimientos += (n))
+#define INS_INICIO(t) double t = omp_get_wtime()
+#define INS_OCUPADO(t) (INS_LOCAL->ocupado += omp_get_wtime() - (t))
+#define INS_BARRERA()                                    \
+	do                                                   \
+	{                                                    \
+		double t_barrera = omp_get_wtime();              \
+		_Pragma("omp barrier");                          \
+		INS_LOCAL->espera += omp_get_wtime() - t_barrera; \
+	} while (0)
+#define INS_BARRERA_FINAL() INS_BARRERA() // sin instrumentar basta con la barrera implícita del final de la región
+#define INS_REGION(t) (ins_regiones += omp_get_wtime() - (t))
+#define INS_PASADA(pasada, t) ins_pasada(pasada, omp_get_wtime() - (t))
+#define INS_ABRE() ins_abre()
+#define INS_REINICIA() ins_reinicia()
+#define INS_MIDE(activo) ins_mide(activo)
+#define INS_INFORME(f, metodo, repeticiones) ins_informe(f, metodo, repeticiones)
+
+#else
+#define INS_COMPARA(n) ((void)0)
+#define INS_MUEVE(n) ((void)0)
+#define INS_INICIO(t)
+#define INS_OCUPADO(t) ((void)0)
+#define INS_BARRERA() _Pragma("omp barrier")
+#define INS_BARRERA_FINAL()
+#define INS_REGION(t) ((void)0)
+#define INS_PASADA(pasada, t) ((void)0)
+#define INS_ABRE() ((void)0)
+#define INS_REINICIA() ((void)0)
+#define INS_MIDE(activo) ((void)0)
+#define INS_INFORME(f, metodo, repeticiones) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+/* Ordenación de un vector: tabla de métodos que puede ejecutar el programa principal
+ *
+ * Para añadir un método basta con declararlo en ordena.h y añadir aquí su descriptor.
+ * max_size evita que los métodos cuadráticos se midan con vectores con los que tardarían horas.
+ * El secuencial equivalente solo se da cuando es el mismo algoritmo en un hilo: la aceleración de un método O(n log n) frente a
+ * uno cuadrático no mide el paralelismo. Sin él, la referencia es el propio método con un hilo.
+ * La versión en un ejecutor (ejecutor.c) es la que puede correr en los hilos de otro programa; -x ejecutores mide todas.
+*/
+
+#include <stddef.h>
+#include "ordena.h"
+
+struct metodo metodos[] = {
+	// nombre, descripción, función, paralelo, complejidad, máximo tamaño, secuencial equivalente, versión en un ejecutor
+	{"sA", "secuencial A", ord_secA, FALSE, "O(n^2)", 50000, NULL, NULL},
+	{"sB", "secuencial B", ord_secB, FALSE, "O(n^2)", 100000, NULL, NULL},
+	{"sC", "secuencial C", ord_secC, FALSE, "O(n^2)", 50000, NULL, NULL},
+	{"sD", "secuencial D", ord_secD, FALSE, "O(n^2)", 50000, NULL, NULL},
+	{"A", "paralelo A", ord_parA, TRUE, "O(n^2)", 50000, "sA", NULL},
+	{"B", "paralelo B", ord_parB, TRUE, "O(n^2)", 100000, "sB", NULL},
+	{"C", "paralelo C", ord_parC, TRUE, "O(n^2)", 50000, "sC", NULL},
+	{"D", "paralelo D", ord_parD, TRUE, "O(n^2)", 50000, "sD", NULL},
+	{"Dm", "paralelo D mejorado", ord_parDm, TRUE, "O(n^2)", 50000, "sD", NULL},
+	{"Am", "paralelo A mejorado", ord_parAm, TRUE, "O(n log n)", 0, NULL, ord_parAm_ejecutor},
+	{"Amk", "paralelo A mejorado con mezcla de k vías", ord_parAmk, TRUE, "O(n log n)", 0, NULL, ord_parAmk_ejecutor},
+	{"An", "paralelo A con tramos naturales", ord_parAn, TRUE, "O(n log n)", 0, NULL, ord_parAn_ejecutor},
+	{"Q", "paralelo Q", ord_parQ, TRUE, "O(n log n)", 0, NULL, ord_parQ_ejecutor},
+	{"R", "paralelo R", ord_parR, TRUE, "O(n)", 0, NULL, ord_parR_ejecutor},
+	{"S", "paralelo S", ord_parS, TRUE, "O(n log n)", 0, NULL, ord_parS_ejecutor},
+	{"Sk", "paralelo S por muestreo regular y mezcla de k vías", ord_parSk, TRUE, "O(n log n)", 0, NULL, ord_parSk_ejecutor},
+	{"Dp", "paralelo D con región persistente", ord_parDp, TRUE, "O(n^2)", 50000, "sD", ord_parDp_ejecutor},
+	{"Db", "paralelo D por bloques", ord_parDb, TRUE, "O(n log n)", 0, NULL, ord_parDb_ejecutor},
+	{"Dbk", "paralelo D por bloques con mezcla de k vías", ord_parDbk, TRUE, "O(n log n)", 0, NULL, ord_parDbk_ejecutor},
+	{"auto", "adaptativo (elige el motor)", ordena, TRUE, "O(n log n)", 0, NULL, ordena_ejecutor},
+};
+const int nmetodos = sizeof(metodos) / sizeof(metodos[0]);
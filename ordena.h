@@ -0,0 +1,285 @@
+/* Ordenación de un vector: declaraciones comunes a la biblioteca de métodos y al programa principal
+ *
+ * - utilidades.c: reserva, copia, impresión y comprobación de vectores y mezcla ordenada in situ
+ * - OrdenaVector.c: métodos secuenciales (ord_sec*)
+ * - OrdenaVectorOMP.c: métodos paralelos (ord_par*) y sus núcleos
+ * - metodos.c: tabla de métodos que puede ejecutar el programa principal
+ * - adaptativo.c: punto de entrada único ordena(), que elige el motor a partir de una muestra del vector
+ * - clavevalor.c: ordenación de claves con valores asociados e índices de la ordenación (argsort)
+ * - tipos.c: motores genéricos (inserción, mezcla y par-impar) generados con plantilla_ordena.h para cada tipo y orden
+ * - generador.c: vectores de entrada con distintas distribuciones, reproducibles con cualquier n.º de hilos
+ * - torneo.c: árbol de perdedores y mezcla de k secuencias ordenadas repartida entre los hilos
+ * - seleccion.c: selección del k-ésimo componente (nth_element) y los k menores ordenados (top-k), en paralelo
+ * - incremental.c: vector ordenado que crece por lotes (cada lote se ordena y se mezcla con lo que ya había)
+ * - ejecutor.c: ejecutores en los que corren los métodos portados: OpenMP o hilos propios con robo de trabajo
+ * - externo.c: ordenación externa de ficheros más grandes que la memoria (tramos ordenados en ficheros temporales y mezcla)
+ * - instrumentacion.c: contadores por hilo y contadores hardware, solo si se compila con -DINSTRUMENTAR (ver instrumentacion.h)
+ * - Ordena.c: programa principal (medición de tiempos)
+*/
+
+#ifndef ORDENA_H
+#define ORDENA_H
+
+#include <stdint.h>
+
+#define RED_MAX 64		// Mayor bloque que se ordena con la red de ordenación (caso base de los métodos mejorados)
+#define min(a, b) ((a) < (b) ? a : b)
+#define max(a, b) ((a) > (b) ? a : b)
+#define FALSE 0
+#define TRUE 1
+
+// ejecutor.c: un ejecutor reparte entre sus hilos un bucle (para) o un árbol de tareas (ejecuta y, dentro, lanza)
+struct ejecutor;
+struct grupo_tareas;
+struct tarea
+{
+	void (*cuerpo)(struct ejecutor *e, const struct tarea *t);
+	void *datos;
+	long ini, fin;				// trozo de índices (en para) o lo que necesite el cuerpo
+	int nivel;					// libre para el cuerpo (la profundidad que le queda al quicksort, por ejemplo)
+	struct grupo_tareas *grupo; // lo rellena el ejecutor de robo
+};
+typedef void (*cuerpo_tarea)(struct ejecutor *e, const struct tarea *t);
+struct ejecutor
+{
+	const char *nombre;
+	int hilos;
+	void (*para)(struct ejecutor *e, long n, cuerpo_tarea cuerpo, void *datos);
+	void (*ejecuta)(struct ejecutor *e, const struct tarea *raiz);
+	void (*lanza)(struct ejecutor *e, const struct tarea *t);
+	void *estado; // estado propio (el de robo apunta a este struct, así que no se puede copiar ni mover)
+};
+int creaEjecutorOpenMP(struct ejecutor *e, int hilos);
+int creaEjecutorRobo(struct ejecutor *e, int hilos, int fijar);
+void liberaEjecutor(struct ejecutor *e);
+void paraTareas(struct ejecutor *e, long n, cuerpo_tarea cuerpo, void *datos);
+
+// utilidades.c
+extern int paginas_grandes;
+void *reservaAlineada(long bytes);
+void liberaAlineada(void *p);
+float *reservaVector(int size);
+void copiarVector(float Vdest[], float V[], int size);
+void *reservaAlineada_ejecutor(struct ejecutor *e, long bytes);
+void copiarVector_ejecutor(struct ejecutor *e, float Vdest[], float V[], int size);
+void printVector(float vector[], int size);
+int primerDesorden(float vector[], int size);
+int primerDesorden_ejecutor(struct ejecutor *e, float vector[], int size);
+int estaOrdenado(float vector[], int size);
+int vectoresIguales(float vecta[], float vectb[], int size);
+int primeraDiferencia(float vecta[], float vectb[], int size);
+int esPermutacion(const float vecta[], const float vectb[], int size);
+void mezcla_ordenada(float vector[], int ini1, int ini2, int fin2, int paralela);
+
+// OrdenaVector.c: funciones que ordenan secuencialmente los size primeros elementos de un vector
+void ord_secA(float vector[], int size);
+void ord_secB(float vector[], int size);
+void ord_secC(float vector[], int size);
+void ord_secD(float vector[], int size);
+
+// OrdenaVectorOMP.c: funciones que ordenan en paralelo los size primeros elementos de un vector
+void ord_parA(float vector[], int size);
+void ord_parAm(float vector[], int size);
+void ord_parAm_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parAmk(float vector[], int size);
+void ord_parAmk_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parAn(float vector[], int size);
+void ord_parAn_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parB(float vector[], int size);
+void ord_parC(float vector[], int size);
+void ord_parD(float vector[], int size);
+void ord_parDm(float vector[], int size);
+void ord_parQ(float vector[], int size);
+void ord_parQ_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parR(float vector[], int size);
+void ord_parR_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parS(float vector[], int size);
+void ord_parS_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parSk(float vector[], int size);
+void ord_parSk_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parDp(float vector[], int size);
+void ord_parDp_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parDb(float vector[], int size);
+void ord_parDb_ejecutor(struct ejecutor *e, float vector[], int size);
+void ord_parDbk(float vector[], int size);
+void ord_parDbk_ejecutor(struct ejecutor *e, float vector[], int size);
+
+// OrdenaVectorOMP.c: núcleos que usan los métodos paralelos
+int hay_avx2(void);
+void ordena_insercion(float vector[], int size);
+void ordena_red(float vector[], int size);
+void mezcla_buffer(const float a[], int na, const float b[], int nb, float destino[]);
+void mezcla_simd(const float a[], int na, const float b[], int nb, float destino[]);
+int co_rango(int k, const float a[], int na, const float b[], int nb);
+void cortes_mezcla(const float a[], int na, const float b[], int nb, int partes, int cortes[]);
+void mezcla_paralela(const float a[], int na, const float b[], int nb, float destino[]);
+typedef void (*nucleo_mezcla)(const float a[], int na, const float b[], int nb, float destino[]);
+void mezcla_repartida(const float a[], int na, const float b[], int nb, float destino[], nucleo_mezcla mezcla);
+int galope(float x, const float v[], int n, int incluidos);
+void mezcla_galope(const float a[], int na, const float b[], int nb, float destino[]);
+void insercion_binaria(float vector[], int ordenados, int size);
+int elige_pivote(float vector[], int size);
+void particion3(float vector[], int size, float pivote, int *lt, int *gt);
+void ordena_monticulo(float vector[], int size);
+int profundidad_maxima(int size);
+void quicksort_intro(float vector[], int size, int prof);
+uint32_t clave_float(float x);
+float float_clave(uint32_t u);
+
+/* Ordenación por base (LSD) repartida entre los hilos de una región paralela (o de un ejecutor), común a ord_parR y a los
+ * motores de clavevalor.c (ver pasadas_base en OrdenaVectorOMP.c)
+ */
+#define RADIX_BITS 8 // Bits de la clave que ordena cada pasada
+#define RADIX_CUBETAS (1 << RADIX_BITS)
+struct ordenacion_base
+{
+	void *datos, *aux;		  // uint32_t (ancho 4: la clave) o uint64_t (ancho 8: la clave es la mitad alta)
+	uint32_t *valores, *vaux; // con ancho 4, valor de 32 bits que se mueve con cada clave (NULL si no hay)
+	int size, ancho;
+	int *cuenta; // cuenta[hilo][cubeta]: omp_get_max_threads() (o e->hilos) * RADIX_CUBETAS enteros
+	int omitir;	 // compartido entre los hilos: la pasada actual no cambia nada
+};
+int pasadas_base(struct ordenacion_base *o);
+int pasadas_base_ejecutor(struct ejecutor *e, struct ordenacion_base *o);
+
+// adaptativo.c: motores entre los que elige ordena() (en el orden de la tabla motores) y umbrales de la elección
+#define MOTOR_ORDENADO 0 // ya estaba ordenado
+#define MOTOR_INSERCION 1
+#define MOTOR_MEZCLA 2
+#define MOTOR_BASE 3
+#define MOTOR_QUICKSORT 4
+struct umbrales
+{
+	int pequeno;	   // hasta este tamaño, inserción
+	int casi;		   // hasta este tamaño, inserción si la muestra no encuentra inversiones
+	int tramo;		   // longitud media estimada de los tramos ordenados desde la que se usa la mezcla
+	int base;		   // desde este tamaño, ordenación por base...
+	double duplicados; // ...si la fracción de duplicados de la muestra no supera esta
+};
+extern struct umbrales umbrales;
+extern const char *motores[];
+int eligeMotor(float vector[], int size);
+void ordena(float vector[], int size);
+void ordena_ejecutor(struct ejecutor *e, float vector[], int size);
+void calibraUmbrales(struct umbrales *u, int max_size);
+
+// clavevalor.c: motores de la ordenación clave-valor (en el orden de la tabla motores_cv), todos estables
+#define CV_MEZCLA 0
+#define CV_BASE 1
+#define CV_PARIMPAR 2
+extern const char *motores_cv[];
+int ordenaClaveValor(float claves[], uint32_t valores[], int size, int motor);
+int ordenaClaveValor64(float claves[], uint64_t valores[], int size, int motor);
+int ordenaIndices(const float claves[], uint32_t indices[], int size, int motor);
+int ordenaIndicesEmpaquetado(const float claves[], uint32_t indices[], int size);
+int compruebaIndices(const float claves[], const uint32_t indices[], int size);
+
+// tipos.c: motores genéricos de plantilla_ordena.h; el sufijo indica el tipo y el orden (_desc descendente, _total orden
+// total de IEEE 754, con los NaN en los extremos, _abs por valor absoluto)
+#define DECLARA_ORDENACION(SUFIJO, TIPO)                         \
+	void ordena_insercion_##SUFIJO(TIPO vector[], int size); \
+	void ordena_mezcla_##SUFIJO(TIPO vector[], int size);    \
+	void ordena_parimpar_##SUFIJO(TIPO vector[], int size);  \
+	int primer_desorden_##SUFIJO(const TIPO vector[], int size);
+DECLARA_ORDENACION(f32, float)
+DECLARA_ORDENACION(f32_desc, float)
+DECLARA_ORDENACION(f32_total, float)
+DECLARA_ORDENACION(f64, double)
+DECLARA_ORDENACION(f64_desc, double)
+DECLARA_ORDENACION(f64_total, double)
+DECLARA_ORDENACION(f64_abs, double)
+DECLARA_ORDENACION(i32, int32_t)
+DECLARA_ORDENACION(i32_desc, int32_t)
+DECLARA_ORDENACION(i64, int64_t)
+DECLARA_ORDENACION(i64_desc, int64_t)
+DECLARA_ORDENACION(u64, uint64_t)
+DECLARA_ORDENACION(u64_desc, uint64_t)
+uint32_t orden_total_f32(float x);
+uint64_t orden_total_f64(double x);
+
+// torneo.c: árbol de perdedores para mezclar k fuentes ordenadas, que pueden llegar por bloques, y mezcla de k secuencias
+// repartida entre los hilos
+struct torneo
+{
+	int k, pendiente;	// n.º de fuentes; fuente a la que hay que dar el siguiente bloque (-1 si ninguna)
+	int *perdedor;		// perdedor[0]: fuente ganadora; perdedor[1..k-1]: perdedora de cada nodo interno
+	uint64_t *clave;	// componente actual de cada fuente con su n.º de fuente (ver torneo.c)
+	char *ultimo;		// el bloque actual es el último de la fuente
+	const float **datos; // bloque actual de cada fuente...
+	long *pos, *fin;	 // ...y posición del componente actual y final del bloque
+};
+int creaTorneo(struct torneo *t, int k);
+void liberaTorneo(struct torneo *t);
+void fuenteTorneo(struct torneo *t, int f, const float datos[], long n, int ultimo);
+void iniciaTorneo(struct torneo *t);
+long mezclaTorneo(struct torneo *t, float destino[], long max);
+uint32_t clave_valor(float x);
+void cortesMultiples(const float *fuentes[], const long longitudes[], int k, long rango, long cortes[]);
+int mezcla_k(const float *fuentes[], const long ini[], const long fin[], int k, float destino[]);
+int mezclaK(const float *fuentes[], const long longitudes[], int k, float destino[]);
+int mezclaK_ejecutor(struct ejecutor *e, const float *fuentes[], const long longitudes[], int k, float destino[]);
+
+// seleccion.c: selección y orden parcial
+float seleccionaK(float vector[], int size, int k);
+int ordenaParcial(const float vector[], int size, int k, float destino[]);
+
+// incremental.c: vector ordenado incremental
+struct vector_ordenado
+{
+	float *datos;	// datos[0..n) ordenados; datos[n..capacidad) es el hueco donde entran los lotes
+	float *reserva; // buffer de la misma capacidad para las mezclas en paralelo (NULL hasta que hace falta)
+	float *lote;	// copia ordenada del último lote
+	int n, capacidad, capacidad_lote;
+};
+int creaOrdenado(struct vector_ordenado *o, int capacidad);
+void liberaOrdenado(struct vector_ordenado *o);
+int insertaLote(struct vector_ordenado *o, const float lote[], int size);
+
+// externo.c: ordenación de ficheros de floats más grandes que la memoria
+#define MEMORIA_EXTERNO 512 // MB que usa por defecto la ordenación externa (opción -l)
+struct resumen_externo
+{
+	long componentes, bloque; // bloque: componentes de cada lectura de la mezcla (0 si no hay mezcla)
+	int tramos, pasadas;	   // pasadas: mezclas intermedias por grupos antes de la final (0 si caben todos los tramos)
+	double t_tramos, t_mezcla; // segundos de cada fase
+};
+int ordenaFichero(const char *entrada, const char *salida, long memoria, struct resumen_externo *res);
+long compruebaFichero(const char *fichero, long *n, uint64_t *huella);
+
+// generador.c: distribuciones de los vectores de entrada (en el orden de la tabla distribuciones)
+#define DIST_UNIFORME 0
+#define DIST_ORDENADO 1
+#define DIST_INVERSO 2
+#define DIST_CASI 3
+#define DIST_POCOS 4
+#define DIST_IGUALES 5
+#define DIST_ZIPF 6
+#define DIST_GAUSS 7
+#define DIST_ORGANO 8
+#define DIST_CEROS 9
+extern const char *distribuciones[];
+extern const int ndistribuciones;
+int buscaDistribucion(const char *nombre);
+uint64_t mezcla64(uint64_t x);
+uint64_t aleatorio64(unsigned semilla, unsigned flujo, uint64_t i);
+double uniforme01(uint64_t x);
+int generaVector(float vector[], int size, int distribucion, int rango, unsigned semilla, long parametro);
+
+// metodos.c: tabla de métodos
+typedef void (*metodo_ordenacion)(float vector[], int size);
+typedef void (*metodo_ejecutor)(struct ejecutor *e, float vector[], int size);
+struct metodo
+{
+	const char *nombre;		 // nombre corto que se usa en -k
+	const char *descripcion; // como aparece en los mensajes
+	metodo_ordenacion ordena;
+	int paralelo;			 // TRUE si reparte el trabajo entre hilos
+	const char *complejidad; // orden del tiempo de ejecución (caso medio)
+	long max_size;			 // mayor n.º de componentes con el que tiene sentido medirlo (0 = sin límite)
+	const char *secuencial;	 // método secuencial con el que se calcula la aceleración (NULL si no tiene)
+	metodo_ejecutor ejecutor; // el mismo método en los hilos de un ejecutor (NULL si no lo hay)
+};
+extern struct metodo metodos[];
+extern const int nmetodos;
+
+#endif
@@ -0,0 +1,246 @@
+/* Ordenación de un vector: plantilla de los motores genéricos (inserción, mezcla y par-impar por bloques)
+ *
+ * No tiene guarda de inclusión: se incluye una vez por cada tipo y criterio de orden (ver tipos.c), definiendo antes:
+ *  - TIPO: tipo de los componentes
+ *  - SUFIJO: sufijo de los nombres generados (ordena_mezcla_SUFIJO...)
+ *  - MENOR(a, b): 1 si a va estrictamente antes que b. Es una macro, así que la comparación queda en línea dentro de los
+ *    bucles, no como con qsort, que llama a una función por cada comparación. Tiene que ser un orden estricto débil.
+ * y, de forma opcional, núcleos más rápidos para un tipo concreto:
+ *  - ORDENA_BLOQUE(v, n): ordena un bloque de como mucho RED_MAX componentes (por defecto, inserción)
+ *  - MEZCLA_RAPIDA(a, na, b, nb, d): mezcla dos tramos ordenados (por defecto, la mezcla estable de la plantilla)
+ * Al final se anulan todas estas macros para poder incluirla otra vez con otro tipo.
+ * Todos los motores son estables si no se dan núcleos propios.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <omp.h>
+#include "ordena.h"
+
+#ifndef CONCATENA
+#define CONCATENA_(nombre, sufijo) nombre##_##sufijo
+#define CONCATENA(nombre, sufijo) CONCATENA_(nombre, sufijo)
+#define F(nombre) CONCATENA(nombre, SUFIJO)
+#define PLANTILLA_MEZCLA_MIN 8192 // Por debajo de este n.º de componentes una mezcla no se reparte entre hilos
+#endif
+
+// Inserción estable: solo se desplaza lo que va estrictamente después
+void F(ordena_insercion)(TIPO vector[], int size)
+{
+	int i, j;
+	TIPO x;
+	for (i = 1; i < size; i++)
+	{
+		x = vector[i];
+		for (j = i - 1; (0 <= j) && MENOR(x, vector[j]); j--)
+			vector[j + 1] = vector[j];
+		vector[j + 1] = x;
+	}
+}
+
+// Mezcla estable (con empate, primero el de a), sin saltos que dependan de los datos
+void F(mezcla)(const TIPO a[], int na, const TIPO b[], int nb, TIPO destino[])
+{
+	int i = 0, j = 0, k = 0, de_b;
+	while ((i < na) && (j < nb))
+	{
+		de_b = MENOR(b[j], a[i]);
+		destino[k++] = de_b ? b[j] : a[i];
+		j += de_b;
+		i += 1 - de_b;
+	}
+	memcpy(destino + k, a + i, (na - i) * sizeof(TIPO));
+	memcpy(destino + k + (na - i), b + j, (nb - j) * sizeof(TIPO));
+}
+
+#ifndef ORDENA_BLOQUE
+#define ORDENA_BLOQUE(v, n) F(ordena_insercion)(v, n)
+#endif
+#ifndef MEZCLA_RAPIDA
+#define MEZCLA_RAPIDA(a, na, b, nb, d) F(mezcla)(a, na, b, nb, d)
+#endif
+
+// Co-rango (merge path) con el mismo desempate que la mezcla: ver co_rango en OrdenaVectorOMP.c
+int F(co_rango)(int k, const TIPO a[], int na, const TIPO b[], int nb)
+{
+	int i, lo = (k > nb) ? k - nb : 0, hi = min(k, na);
+	while (lo < hi)
+	{
+		i = lo + (hi - lo) / 2;
+		if (!MENOR(b[k - i - 1], a[i]))
+			lo = i + 1;
+		else
+			hi = i;
+	}
+	return lo;
+}
+
+void F(mezcla_paralela)(const TIPO a[], int na, const TIPO b[], int nb, TIPO destino[])
+{
+	int p, np = omp_get_max_threads(), n = na + nb;
+	if ((n < PLANTILLA_MEZCLA_MIN) || (np == 1))
+	{
+		MEZCLA_RAPIDA(a, na, b, nb, destino);
+		return;
+	}
+	#pragma omp parallel for schedule(static)
+	for (p = 0; p < np; p++)
+	{
+		int k0 = (long)p * n / np, k1 = (long)(p + 1) * n / np;
+		int i0 = F(co_rango)(k0, a, na, b, nb), i1 = F(co_rango)(k1, a, na, b, nb);
+		MEZCLA_RAPIDA(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0), destino + k0);
+	}
+}
+
+// Ordenación por mezcla en un solo hilo con un buffer aux del mismo tamaño; deja el resultado en vector
+void F(ordena_mezcla_secuencial)(TIPO vector[], int size, TIPO aux[])
+{
+	int p, ancho;
+	TIPO *origen = vector, *destino = aux, *temp;
+	for (p = 0; p < size; p += RED_MAX)
+		ORDENA_BLOQUE(vector + p, min(RED_MAX, size - p));
+	for (ancho = RED_MAX; ancho < size; ancho = 2 * ancho)
+	{
+		for (p = 0; p < size; p += 2 * ancho)
+		{
+			int med = min(p + ancho, size), fin = min(p + 2 * ancho, size);
+			MEZCLA_RAPIDA(origen + p, med - p, origen + med, fin - med, destino + p);
+		}
+		temp = origen, origen = destino, destino = temp;
+	}
+	if (origen != vector)
+		memcpy(vector, origen, size * sizeof(TIPO));
+}
+
+// Montículo (in situ, no estable): solo se usa si no hay memoria para el buffer de los otros motores
+void F(ordena_monticulo)(TIPO vector[], int size)
+{
+	int ini, fin, raiz, hijo;
+	TIPO temp;
+	for (ini = size / 2 - 1, fin = size; fin > 1;)
+	{
+		if (ini >= 0)
+			raiz = ini--;
+		else
+		{
+			temp = vector[0], vector[0] = vector[--fin], vector[fin] = temp;
+			raiz = 0;
+		}
+		while ((hijo = 2 * raiz + 1) < fin)
+		{
+			if ((hijo + 1 < fin) && MENOR(vector[hijo], vector[hijo + 1]))
+				hijo++;
+			if (!MENOR(vector[raiz], vector[hijo]))
+				break;
+			temp = vector[raiz], vector[raiz] = vector[hijo], vector[hijo] = temp;
+			raiz = hijo;
+		}
+	}
+}
+
+// Motor de mezcla: el esquema de ord_parAm (bloques en paralelo y niveles de mezclas repartidas por parejas o por merge path)
+void F(ordena_mezcla)(TIPO vector[], int size)
+{
+	int ancho, p, npares, nhilos = omp_get_max_threads();
+	TIPO *origen, *destino, *temp, *aux = (TIPO *)reservaAlineada((long)size * sizeof(TIPO));
+
+	if (aux == NULL)
+	{
+		F(ordena_monticulo)(vector, size);
+		return;
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (p = 0; p < size; p += RED_MAX)
+		ORDENA_BLOQUE(vector + p, min(RED_MAX, size - p));
+
+	origen = vector;
+	destino = aux;
+	for (ancho = RED_MAX; ancho < size; ancho = 2 * ancho)
+	{
+		npares = (size - 1) / (2 * ancho) + 1;
+		if (npares >= nhilos)
+		{
+			#pragma omp parallel for schedule(static)
+			for (p = 0; p < npares; p++)
+			{
+				int ini = 2 * ancho * p, med = min(ini + ancho, size), fin = min(ini + 2 * ancho, size);
+				MEZCLA_RAPIDA(origen + ini, med - ini, origen + med, fin - med, destino + ini);
+			}
+		}
+		else
+			for (p = 0; p < npares; p++)
+			{
+				int ini = 2 * ancho * p, med = min(ini + ancho, size), fin = min(ini + 2 * ancho, size);
+				F(mezcla_paralela)(origen + ini, med - ini, origen + med, fin - med, destino + ini);
+			}
+		temp = origen, origen = destino, destino = temp;
+	}
+
+	if (origen != vector)
+	{
+		#pragma omp parallel for schedule(static)
+		for (p = 0; p < size; p++)
+			vector[p] = origen[p];
+	}
+	liberaAlineada(aux);
+}
+
+// Motor par-impar por bloques: el esquema de ord_parDb, con la mezcla secuencial para ordenar cada bloque
+void F(ordena_parimpar)(TIPO vector[], int size)
+{
+	int nbloques = omp_get_max_threads(), tam = (size + nbloques - 1) / nbloques;
+	TIPO *aux = (TIPO *)reservaAlineada((long)size * sizeof(TIPO));
+
+	if (aux == NULL)
+	{
+		F(ordena_monticulo)(vector, size);
+		return;
+	}
+
+	#pragma omp parallel
+	{
+		int b, fase;
+
+		#pragma omp for schedule(static)
+		for (b = 0; b < nbloques; b++)
+		{
+			int ini = min((long)b * tam, size), fin = min((long)(b + 1) * tam, size);
+			F(ordena_mezcla_secuencial)(vector + ini, fin - ini, aux + ini);
+		}
+
+		for (fase = 0; fase < nbloques; fase++)
+		{
+			#pragma omp for schedule(static)
+			for (b = fase % 2; b < nbloques - 1; b += 2)
+			{
+				int ini = min((long)b * tam, size), med = min((long)(b + 1) * tam, size), fin = min((long)(b + 2) * tam, size);
+				if ((ini < med) && (med < fin) && MENOR(vector[med], vector[med - 1]))
+				{ // Mezcla-división: la pareja se salta si ya está en orden
+					MEZCLA_RAPIDA(vector + ini, med - ini, vector + med, fin - med, aux + ini);
+					memcpy(vector + ini, aux + ini, (fin - ini) * sizeof(TIPO));
+				}
+			}
+		}
+	}
+
+	liberaAlineada(aux);
+}
+
+// Primera posición i con vector[i+1] antes que vector[i] según MENOR, o -1 si está ordenado
+int F(primer_desorden)(const TIPO vector[], int size)
+{
+	int i, primera = INT_MAX;
+	#pragma omp parallel for schedule(static) reduction(min : primera)
+	for (i = 0; i < size - 1; i++)
+		if (MENOR(vector[i + 1], vector[i]) && (i < primera))
+			primera = i;
+	return (primera == INT_MAX) ? -1 : primera;
+}
+
+#undef TIPO
+#undef SUFIJO
+#undef MENOR
+#undef ORDENA_BLOQUE
+#undef MEZCLA_RAPIDA
@@ -0,0 +1,232 @@
+/* Ordenación de un vector: selección del k-ésimo (nth_element) y orden parcial (los k menores, ordenados)
+ *
+ * seleccionaK deja en vector[k] el componente que quedaría ahí si se ordenase el vector, con menores o iguales delante y
+ * mayores o iguales detrás, sin ordenar nada más. Mientras el trozo que contiene a k es grande, cada pasada es una de
+ * Floyd-Rivest en paralelo: de una muestra ordenada salen dos pivotes que encierran a k con mucha probabilidad, cada hilo
+ * cuenta cuántos componentes de su trozo quedan por debajo, entre y por encima de ellos, y con una suma prefija (como en
+ * ord_parS) los reparte en aux en tres franjas, que se devuelven a vector. La franja central, que es la que contiene a k
+ * casi siempre, es del orden de 2*SELECCION_HOLGURA/SELECCION_MUESTRAS del trozo, así que la siguiente pasada solo recorre
+ * eso (incluso con un hilo, una pasada así, sin intercambios, es más rápida que las particiones de introselect con muchos
+ * iguales). Cuando el trozo ya es pequeño se termina en un hilo con introselect (quickselect con particion3 y, si degenera,
+ * ordenación por montículo, igual que quicksort_intro).
+ *
+ * ordenaParcial deja en destino los k menores, ordenados, sin tocar el vector. Con k pequeño frente al trozo de cada hilo,
+ * cada hilo guarda los k menores de su trozo en un montículo de máximos propio (casi todos los componentes solo se comparan
+ * con la raíz y se descartan), ordena su montículo y los k primeros de la mezcla salen con cortesMultiples y mezcla_k de
+ * torneo.c. Con k grande se copia el vector, se separan los k menores con seleccionaK y se ordenan con ordena().
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define SELECCION_MIN 65536		// Trozos más pequeños que este se terminan con introselect en un solo hilo
+#define SELECCION_MUESTRAS 4096 // Muestras de cada pasada de Floyd-Rivest...
+#define SELECCION_HOLGURA 128	// ...y muestras que se dejan a cada lado de la posición de k (2 * sqrt(SELECCION_MUESTRAS))
+#define TOPK_MONTICULO 64		// ordenaParcial usa montículos si cada hilo tiene al menos TOPK_MONTICULO * k componentes
+
+// Introselect en un hilo: como quicksort_intro, pero solo se sigue por la parte que contiene a k
+void selecciona_secuencial(float vector[], int size, int k)
+{
+	int lt, gt, prof = profundidad_maxima(size);
+	while (size > RED_MAX)
+	{
+		if (prof-- == 0)
+		{
+			ordena_monticulo(vector, size);
+			return;
+		}
+		particion3(vector, size, vector[elige_pivote(vector, size)], &lt, &gt);
+		if (k < lt)
+			size = lt;
+		else if (k > gt)
+		{
+			vector += gt + 1;
+			size -= gt + 1;
+			k -= gt + 1;
+		}
+		else
+			return; // k ha caído entre los iguales al pivote
+	}
+	ordena_red(vector, size);
+}
+
+float seleccionaK(float vector[], int size, int k)
+{
+	int p, pasada, s, anterior, base = 0, n = size, nhilos = omp_get_max_threads(), total[3];
+	float muestras[SELECCION_MUESTRAS], lo, hi, *v, *aux = NULL;
+	int *cuenta = NULL; // cuenta[trozo][franja]
+
+	if (size >= SELECCION_MIN)
+	{
+		aux = reservaVector(size);
+		cuenta = (int *)malloc(3 * nhilos * sizeof(int));
+	}
+	for (pasada = 0; (aux != NULL) && (cuenta != NULL) && (n >= SELECCION_MIN); pasada++)
+	{
+		/*
+		 * 1. Pivotes: las muestras son posiciones pseudoaleatorias del trozo, distintas en cada pasada, y los pivotes son las
+		 *    muestras a SELECCION_HOLGURA posiciones de donde caería k en la muestra ordenada (-inf o +inf si se sale).
+		 */
+		v = vector + base;
+		for (p = 0; p < SELECCION_MUESTRAS; p++)
+			muestras[p] = v[mezcla64(((uint64_t)pasada << 32) | (uint32_t)p) % (uint64_t)n];
+		quicksort_intro(muestras, SELECCION_MUESTRAS, profundidad_maxima(SELECCION_MUESTRAS));
+		s = (long)(k - base) * SELECCION_MUESTRAS / n;
+		lo = (s >= SELECCION_HOLGURA) ? muestras[s - SELECCION_HOLGURA] : -INFINITY;
+		hi = (s + SELECCION_HOLGURA < SELECCION_MUESTRAS) ? muestras[s + SELECCION_HOLGURA] : INFINITY;
+
+		/*
+		 * 2. Partición en tres franjas (x < lo, lo <= x <= hi, x > hi) con un solo reparto, como el de ord_parS: cada hilo
+		 *    cuenta las de su trozo estático, la suma prefija (franja a franja y, dentro de cada una, trozo a trozo) da dónde
+		 *    escribe cada hilo en aux y cada hilo devuelve a vector su mismo trozo de aux, después de una barrera.
+		 */
+		#pragma omp parallel
+		{
+			int i;
+
+			#pragma omp for schedule(static)
+			for (p = 0; p < nhilos; p++)
+			{
+				int ini = (long)p * n / nhilos, fin = (long)(p + 1) * n / nhilos, *mias = cuenta + 3 * p;
+				mias[0] = mias[1] = mias[2] = 0;
+				for (i = ini; i < fin; i++)
+					mias[(v[i] >= lo) + (v[i] > hi)]++;
+			}
+
+			#pragma omp single
+			{
+				int q, f, c, suma = 0;
+				for (f = 0; f < 3; f++)
+				{
+					total[f] = suma;
+					for (q = 0; q < nhilos; q++)
+					{
+						c = cuenta[3 * q + f];
+						cuenta[3 * q + f] = suma;
+						suma += c;
+					}
+					total[f] = suma - total[f];
+				}
+			}
+
+			#pragma omp for schedule(static)
+			for (p = 0; p < nhilos; p++)
+			{
+				int ini = (long)p * n / nhilos, fin = (long)(p + 1) * n / nhilos, *mias = cuenta + 3 * p;
+				for (i = ini; i < fin; i++)
+					aux[mias[(v[i] >= lo) + (v[i] > hi)]++] = v[i];
+			}
+
+			#pragma omp for schedule(static)
+			for (i = 0; i < n; i++)
+				v[i] = aux[i];
+		}
+
+		// 3. Se sigue por la franja que contiene a k; si es la central y lo == hi, todos sus componentes son iguales
+		anterior = n;
+		if (k - base < total[0])
+			n = total[0];
+		else if (k - base < total[0] + total[1])
+		{
+			base += total[0];
+			n = (lo == hi) ? 1 : total[1];
+		}
+		else
+		{
+			base += total[0] + total[1];
+			n = total[2];
+		}
+		if (n == anterior)
+			break; // Todo ha caído en la misma franja (muchos iguales a un pivote): no se ha avanzado
+	}
+	selecciona_secuencial(vector + base, n, k - base);
+
+	liberaAlineada(aux);
+	free(cuenta);
+	return vector[k];
+}
+
+// Hunde la raíz de un montículo de máximos de n componentes hasta su sitio
+void hunde_monticulo(float monticulo[], int n, int raiz)
+{
+	int hijo;
+	float x = monticulo[raiz];
+	while ((hijo = 2 * raiz + 1) < n)
+	{
+		if ((hijo + 1 < n) && (monticulo[hijo] < monticulo[hijo + 1]))
+			hijo++;
+		if (x >= monticulo[hijo])
+			break;
+		monticulo[raiz] = monticulo[hijo];
+		raiz = hijo;
+	}
+	monticulo[raiz] = x;
+}
+
+int ordenaParcial(const float vector[], int size, int k, float destino[])
+{
+	int p, nhilos = omp_get_max_threads(), correcto = TRUE;
+	float *monticulos, *aux;
+	const float **fuentes;
+	long *longitudes, *limites;
+
+	k = min(k, size);
+	if (k <= 0)
+		return TRUE;
+	if ((long)k * TOPK_MONTICULO * nhilos > size)
+	{ // k grande: seleccionar en una copia y ordenar los k menores
+		if ((aux = reservaVector(size)) == NULL)
+			return FALSE;
+		copiarVector(aux, (float *)vector, size);
+		seleccionaK(aux, size, k - 1);
+		ordena(aux, k);
+		copiarVector(destino, aux, k);
+		liberaAlineada(aux);
+		return TRUE;
+	}
+
+	monticulos = (float *)malloc((long)nhilos * k * sizeof(float));
+	fuentes = (const float **)malloc(nhilos * sizeof(float *));
+	longitudes = (long *)malloc(nhilos * sizeof(long));
+	limites = (long *)calloc(2 * nhilos, sizeof(long)); // inicio (0) y fin de lo que se toma de cada montículo
+	if ((monticulos == NULL) || (fuentes == NULL) || (longitudes == NULL) || (limites == NULL))
+		correcto = FALSE;
+	else
+	{
+		#pragma omp parallel for schedule(static)
+		for (p = 0; p < nhilos; p++)
+		{
+			int i, ini = (long)p * size / nhilos, fin = (long)(p + 1) * size / nhilos, m = min(k, fin - ini);
+			float *monticulo = monticulos + (long)p * k;
+			memcpy(monticulo, vector + ini, m * sizeof(float));
+			for (i = m / 2 - 1; i >= 0; i--)
+				hunde_monticulo(monticulo, m, i);
+			for (i = ini + m; i < fin; i++)
+				if (vector[i] < monticulo[0])
+				{ // La raíz es el mayor de los k menores vistos: el nuevo la sustituye
+					monticulo[0] = vector[i];
+					hunde_monticulo(monticulo, m, 0);
+				}
+			quicksort_intro(monticulo, m, profundidad_maxima(m));
+			fuentes[p] = monticulo;
+			longitudes[p] = m;
+		}
+		cortesMultiples(fuentes, longitudes, nhilos, k, limites + nhilos);
+		correcto = mezcla_k(fuentes, limites, limites + nhilos, nhilos, destino);
+	}
+
+	free(monticulos);
+	free(fuentes);
+	free(longitudes);
+	free(limites);
+	return correcto;
+}
@@ -0,0 +1,107 @@
+/* Ordenación de un vector: motores genéricos generados con plantilla_ordena.h para cada tipo y criterio de orden
+ *
+ * Para añadir un tipo o un criterio basta con definir TIPO, SUFIJO y MENOR, incluir la plantilla aquí y declarar las
+ * funciones en ordena.h con DECLARA_ORDENACION. Solo se generan los esquemas de ord_parAm (mezcla) y ord_parDb (par-impar por
+ * bloques), con la inserción para los bloques; Q, R, S, An y los demás métodos siguen siendo solo para float.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "ordena.h"
+
+/* Orden total de IEEE 754 (totalOrder): -NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN. Se compara la representación binaria
+ * como entero sin signo después de invertir los negativos, igual que clave_float, pero en el mismo fichero para que el
+ * compilador lo deje en línea dentro de las comparaciones.
+ */
+uint32_t orden_total_f32(float x)
+{
+	uint32_t u;
+	memcpy(&u, &x, sizeof(u));
+	return u ^ ((uint32_t)((int32_t)u >> 31) | 0x80000000u);
+}
+
+uint64_t orden_total_f64(double x)
+{
+	uint64_t u;
+	memcpy(&u, &x, sizeof(u));
+	return u ^ ((uint64_t)((int64_t)u >> 63) | 0x8000000000000000ULL);
+}
+
+/* float: con los núcleos vectorizados de los métodos mejorados. La mezcla vectorizada no es estable, pero con < los únicos
+ * float iguales que se distinguen son -0 y +0, que pueden salir en cualquier orden entre sí; para separarlos, o con NaN
+ * (con los que < no es un orden), hay que usar f32_total.
+ */
+#define TIPO float
+#define SUFIJO f32
+#define MENOR(a, b) ((a) < (b))
+#define ORDENA_BLOQUE(v, n) ordena_red(v, n)
+#define MEZCLA_RAPIDA(a, na, b, nb, d) mezcla_simd(a, na, b, nb, d)
+#include "plantilla_ordena.h"
+
+#define TIPO float
+#define SUFIJO f32_desc
+#define MENOR(a, b) ((b) < (a))
+#include "plantilla_ordena.h"
+
+#define TIPO float
+#define SUFIJO f32_total
+#define MENOR(a, b) (orden_total_f32(a) < orden_total_f32(b))
+#include "plantilla_ordena.h"
+
+#define TIPO double
+#define SUFIJO f64
+#define MENOR(a, b) ((a) < (b))
+#include "plantilla_ordena.h"
+
+#define TIPO double
+#define SUFIJO f64_desc
+#define MENOR(a, b) ((b) < (a))
+#include "plantilla_ordena.h"
+
+#define TIPO double
+#define SUFIJO f64_total
+#define MENOR(a, b) (orden_total_f64(a) < orden_total_f64(b))
+#include "plantilla_ordena.h"
+
+// Ejemplo de comparación propia: por valor absoluto
+#define TIPO double
+#define SUFIJO f64_abs
+#define MENOR(a, b) (fabs(a) < fabs(b))
+#include "plantilla_ordena.h"
+
+#define TIPO int32_t
+#define SUFIJO i32
+#define MENOR(a, b) ((a) < (b))
+#include "plantilla_ordena.h"
+
+#define TIPO int32_t
+#define SUFIJO i32_desc
+#define MENOR(a, b) ((b) < (a))
+#include "plantilla_ordena.h"
+
+#define TIPO int64_t
+#define SUFIJO i64
+#define MENOR(a, b) ((a) < (b))
+#include "plantilla_ordena.h"
+
+#define TIPO int64_t
+#define SUFIJO i64_desc
+#define MENOR(a, b) ((b) < (a))
+#include "plantilla_ordena.h"
+
+#define TIPO uint64_t
+#define SUFIJO u64
+#define MENOR(a, b) ((a) < (b))
+#include "plantilla_ordena.h"
+
+#define TIPO uint64_t
+#define SUFIJO u64_desc
+#define MENOR(a, b) ((b) < (a))
+#include "plantilla_ordena.h"
@@ -0,0 +1,338 @@
+/* Ordenación de un vector: árbol de perdedores (torneo) para mezclar k secuencias ordenadas
+ *
+ * Cada hoja es una fuente (una secuencia ordenada, que puede llegar por bloques) y cada nodo interno guarda la fuente que
+ * perdió la comparación en ese nodo; perdedor[0] es la ganadora absoluta, la de menor clave. Al sacar la ganadora solo hay
+ * que rehacer el camino de su hoja a la raíz: log2(k) comparaciones, cada una contra el perdedor guardado en el nodo, sin
+ * mirar al hermano como en un montículo. Los nodos se guardan como en un montículo (los hijos del nodo n son 2n y 2n+1 y la
+ * hoja de la fuente f es el nodo k + f), lo que vale para cualquier k, y la clave actual de cada fuente se copia en clave[],
+ * un vector pequeño y contiguo, para no saltar a los datos de la fuente en cada comparación.
+ *
+ * Cada clave es un entero de 64 bits: arriba el float en orden total (como orden_total_f32 de tipos.c, pero con -0 igual a
+ * +0, como con <) y abajo el n.º de fuente, así que cada partido es una sola comparación de enteros sin saltos y, con empate,
+ * gana la fuente de menor índice (la mezcla es estable si las fuentes van en orden). Una fuente agotada tiene la clave
+ * máxima, AGOTADA, que pierde contra todas.
+ *
+ * mezclaK reparte una mezcla de k secuencias entre los hilos: cada hilo calcula con cortesMultiples (selección en varias
+ * secuencias) dónde empieza y dónde termina su parte de la salida en cada fuente y mezcla esa parte con su propio torneo, así
+ * que cada hilo escribe un trozo disjunto de la salida y la mezcla completa es un solo pase por memoria.
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <omp.h>
+#include "ordena.h"
+
+#define AGOTADA UINT64_MAX
+#define MEZCLA_K_MIN 8192 // Por debajo de este n.º de componentes por hilo una mezcla de k secuencias no se reparte
+
+// Entero sin signo con el mismo orden que < entre floats que no son NaN (x + 0.0f convierte -0 en +0)
+uint32_t clave_valor(float x)
+{
+	uint32_t u;
+	x = x + 0.0f;
+	memcpy(&u, &x, sizeof(u));
+	return u ^ ((uint32_t)((int32_t)u >> 31) | 0x80000000u);
+}
+
+// Clave del componente x de la fuente f
+uint64_t clave_torneo(float x, int f)
+{
+	return ((uint64_t)clave_valor(x) << 32) | (uint32_t)f;
+}
+
+int creaTorneo(struct torneo *t, int k)
+{
+	t->k = k;
+	t->pendiente = -1;
+	t->perdedor = (int *)malloc(3 * (long)k * sizeof(int)); // perdedor[k] y ganadores[2k] para iniciar el torneo
+	t->clave = (uint64_t *)malloc(k * sizeof(uint64_t));
+	t->ultimo = (char *)calloc(k, 1);
+	t->datos = (const float **)calloc(k, sizeof(float *));
+	t->pos = (long *)calloc(k, sizeof(long));
+	t->fin = (long *)calloc(k, sizeof(long));
+	if ((k < 1) || (t->perdedor == NULL) || (t->clave == NULL) || (t->ultimo == NULL) ||
+		(t->datos == NULL) || (t->pos == NULL) || (t->fin == NULL))
+	{
+		liberaTorneo(t);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void liberaTorneo(struct torneo *t)
+{
+	free(t->perdedor);
+	free(t->clave);
+	free(t->ultimo);
+	free(t->datos);
+	free(t->pos);
+	free(t->fin);
+	t->perdedor = NULL;
+	t->clave = NULL;
+	t->ultimo = NULL;
+	t->datos = NULL;
+	t->pos = t->fin = NULL;
+}
+
+/* Bloque actual de la fuente f: n componentes ordenados en datos (que tienen que seguir ahí mientras se mezcla). ultimo dice
+ * si es el último bloque de la fuente. Se usa antes de iniciaTorneo para todas las fuentes y después solo con la pendiente.
+ */
+void fuenteTorneo(struct torneo *t, int f, const float datos[], long n, int ultimo)
+{
+	t->datos[f] = datos;
+	t->pos[f] = 0;
+	t->fin[f] = n;
+	t->ultimo[f] = ultimo;
+}
+
+// Rehace el camino de la hoja de la fuente f a la raíz después de cambiar su clave
+void repiteTorneo(struct torneo *t, int f)
+{
+	int n, p, g, *perdedor = t->perdedor;
+	const uint64_t *clave = t->clave;
+	for (n = (f + t->k) / 2; n >= 1; n /= 2)
+	{
+		p = perdedor[n];
+		g = clave[p] < clave[f];
+		perdedor[n] = g ? f : p;
+		f = g ? p : f;
+	}
+	perdedor[0] = f;
+}
+
+void iniciaTorneo(struct torneo *t)
+{
+	int f, n, k = t->k, *ganadores = t->perdedor + k;
+	const uint64_t *clave = t->clave;
+	for (f = 0; f < k; f++)
+	{ // Un bloque vacío que no es el último se trata como el final de la fuente
+		t->clave[f] = (t->pos[f] < t->fin[f]) ? clave_torneo(t->datos[f][t->pos[f]], f) : AGOTADA;
+		ganadores[k + f] = f;
+	}
+	for (n = k - 1; n >= 1; n--)
+		if (clave[ganadores[2 * n]] < clave[ganadores[2 * n + 1]])
+		{
+			ganadores[n] = ganadores[2 * n];
+			t->perdedor[n] = ganadores[2 * n + 1];
+		}
+		else
+		{
+			ganadores[n] = ganadores[2 * n + 1];
+			t->perdedor[n] = ganadores[2 * n];
+		}
+	t->perdedor[0] = (k > 1) ? ganadores[1] : 0;
+	t->pendiente = -1;
+}
+
+/* Saca en orden los componentes de las fuentes a destino hasta llenar max, hasta que se acaban todas o hasta que se acaba
+ * el bloque de una fuente que tiene más: en ese caso queda en t->pendiente y hay que darle el siguiente bloque con
+ * fuenteTorneo antes de volver a llamar. Devuelve cuántos componentes ha escrito. Si devuelve menos de max y no hay
+ * pendiente, la mezcla ha terminado.
+ */
+long mezclaTorneo(struct torneo *t, float destino[], long max)
+{
+	long o = 0, *pos = t->pos, *fin = t->fin;
+	int f, n, p, g, k = t->k, *perdedor = t->perdedor;
+	uint64_t *clave = t->clave;
+	const float **datos = t->datos;
+
+	if ((f = t->pendiente) >= 0)
+	{
+		if (pos[f] < fin[f])
+			clave[f] = clave_torneo(datos[f][pos[f]], f);
+		else if (t->ultimo[f])
+			clave[f] = AGOTADA;
+		else
+			return 0;
+		t->pendiente = -1;
+		repiteTorneo(t, f);
+	}
+	while (o < max)
+	{
+		f = perdedor[0];
+		if (clave[f] == AGOTADA)
+			break; // Si la ganadora está agotada, lo están todas
+		destino[o++] = datos[f][pos[f]];
+		if (++pos[f] < fin[f])
+			clave[f] = clave_torneo(datos[f][pos[f]], f);
+		else if (t->ultimo[f])
+			clave[f] = AGOTADA;
+		else
+		{
+			t->pendiente = f;
+			break;
+		}
+		for (n = (f + k) / 2; n >= 1; n /= 2)
+		{ // repiteTorneo en línea
+			p = perdedor[n];
+			g = clave[p] < clave[f];
+			perdedor[n] = g ? f : p;
+			f = g ? p : f;
+		}
+		perdedor[0] = f;
+	}
+	return o;
+}
+
+// N.º de componentes de v[0..n) ordenado con clave menor que c (o menor o igual, si iguales)
+long cuenta_clave(const float v[], long n, uint32_t c, int iguales)
+{
+	long lo = 0, hi = n, m;
+	while (lo < hi)
+	{
+		m = lo + (hi - lo) / 2;
+		if ((clave_valor(v[m]) < c) || (iguales && (clave_valor(v[m]) == c)))
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+/* Selección en varias secuencias: deja en cortes[f] cuántos componentes de la fuente f van entre los rango primeros de la
+ * mezcla de las k fuentes ordenadas, con el mismo desempate que el torneo (con iguales, antes los de la fuente de menor
+ * índice). Busca por bisección sobre las claves de 32 bits la menor clave c con más de rango componentes menores o iguales;
+ * los menores que c entran todos y los iguales a c, fuente a fuente, hasta completar rango. 32 pasos de k búsquedas binarias.
+ */
+void cortesMultiples(const float *fuentes[], const long longitudes[], int k, long rango, long cortes[])
+{
+	uint32_t lo = 0, hi = UINT32_MAX, c;
+	long total = 0, resto, iguales;
+	int f;
+
+	for (f = 0; f < k; f++)
+		total += longitudes[f];
+	if (rango >= total)
+	{
+		for (f = 0; f < k; f++)
+			cortes[f] = longitudes[f];
+		return;
+	}
+	while (lo < hi)
+	{
+		c = lo + (hi - lo) / 2;
+		for (total = 0, f = 0; f < k; f++)
+			total += cuenta_clave(fuentes[f], longitudes[f], c, TRUE);
+		if (total > rango)
+			hi = c;
+		else
+			lo = c + 1;
+	}
+	resto = rango;
+	for (f = 0; f < k; f++)
+	{
+		cortes[f] = cuenta_clave(fuentes[f], longitudes[f], lo, FALSE);
+		resto -= cortes[f];
+	}
+	for (f = 0; (f < k) && (resto > 0); f++)
+	{
+		iguales = min(cuenta_clave(fuentes[f], longitudes[f], lo, TRUE) - cortes[f], resto);
+		cortes[f] += iguales;
+		resto -= iguales;
+	}
+}
+
+/* Mezcla en un hilo los trozos [ini[f], fin[f]) de las k fuentes en destino: con dos fuentes, la mezcla vectorizada; con más,
+ * un torneo. Devuelve FALSE si no hay memoria para el torneo.
+ */
+int mezcla_k(const float *fuentes[], const long ini[], const long fin[], int k, float destino[])
+{
+	struct torneo t;
+	int f;
+
+	if (k == 1)
+		memcpy(destino, fuentes[0] + ini[0], (fin[0] - ini[0]) * sizeof(float));
+	else if (k == 2)
+		mezcla_simd(fuentes[0] + ini[0], (int)(fin[0] - ini[0]), fuentes[1] + ini[1], (int)(fin[1] - ini[1]), destino);
+	else
+	{
+		if (!creaTorneo(&t, k))
+			return FALSE;
+		for (f = 0; f < k; f++)
+			fuenteTorneo(&t, f, fuentes[f] + ini[f], fin[f] - ini[f], TRUE);
+		iniciaTorneo(&t);
+		mezclaTorneo(&t, destino, LONG_MAX);
+		liberaTorneo(&t);
+	}
+	return TRUE;
+}
+
+/* Mezcla las k fuentes ordenadas (fuentes[f] con longitudes[f] componentes) en destino, repartida entre los hilos: el hilo t
+ * escribe los componentes [t*n/nt, (t+1)*n/nt) de la salida. Devuelve FALSE si no hay memoria (destino queda a medias).
+ */
+int mezclaK(const float *fuentes[], const long longitudes[], int k, float destino[])
+{
+	long n = 0;
+	int f, correcto = TRUE, nhilos = omp_get_max_threads();
+
+	for (f = 0; f < k; f++)
+		n += longitudes[f];
+	if (n < (long)nhilos * MEZCLA_K_MIN)
+		nhilos = 1;
+	#pragma omp parallel num_threads(nhilos) reduction(&& : correcto)
+	{
+		int t = omp_get_thread_num(), nt = omp_get_num_threads();
+		long ini = n * t / nt, fin = n * (t + 1) / nt, *cortes = (long *)malloc(2 * (long)k * sizeof(long));
+		if (cortes == NULL)
+			correcto = FALSE;
+		else
+		{
+			cortesMultiples(fuentes, longitudes, k, ini, cortes);
+			cortesMultiples(fuentes, longitudes, k, fin, cortes + k);
+			correcto = mezcla_k(fuentes, cortes, cortes + k, k, destino + ini);
+			free(cortes);
+		}
+	}
+	return correcto;
+}
+
+// Mezcla de k vías de mezclaK_ejecutor: la parte p escribe los componentes [p*n/partes, (p+1)*n/partes) de la salida
+struct mezcla_vias
+{
+	const float **fuentes;
+	const long *longitudes;
+	float *destino;
+	long n;
+	int k, partes;
+	int correcto; // lo pone a FALSE la parte que se queda sin memoria
+};
+
+void mezcla_parte_k(struct ejecutor *e, const struct tarea *t)
+{
+	struct mezcla_vias *m = (struct mezcla_vias *)t->datos;
+	long p, ini, fin, *cortes = (long *)malloc(2 * (long)m->k * sizeof(long));
+	(void)e;
+	for (p = t->ini; (cortes != NULL) && (p < t->fin); p++)
+	{
+		ini = m->n * p / m->partes;
+		fin = m->n * (p + 1) / m->partes;
+		cortesMultiples(m->fuentes, m->longitudes, m->k, ini, cortes);
+		cortesMultiples(m->fuentes, m->longitudes, m->k, fin, cortes + m->k);
+		if (!mezcla_k(m->fuentes, cortes, cortes + m->k, m->k, m->destino + ini))
+			__atomic_store_n(&m->correcto, FALSE, __ATOMIC_RELAXED);
+	}
+	if (cortes == NULL)
+		__atomic_store_n(&m->correcto, FALSE, __ATOMIC_RELAXED);
+	free(cortes);
+}
+
+// mezclaK en los hilos de un ejecutor: una parte de la salida por hilo
+int mezclaK_ejecutor(struct ejecutor *e, const float *fuentes[], const long longitudes[], int k, float destino[])
+{
+	struct mezcla_vias m = {fuentes, longitudes, destino, 0, k, e->hilos, TRUE};
+	int f;
+
+	for (f = 0; f < k; f++)
+		m.n += longitudes[f];
+	if (m.n < (long)m.partes * MEZCLA_K_MIN)
+		m.partes = 1;
+	e->para(e, m.partes, mezcla_parte_k, &m);
+	return m.correcto;
+}
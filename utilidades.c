@@ -0,0 +1,362 @@
+/* Ordenación de un vector: funciones comunes a los métodos secuenciales y paralelos
+ * (reserva alineada, copia, impresión y comprobación de vectores y mezcla ordenada in situ)
+*/
+
+/*
+ * Autores:
+ * - Sergio Jiménez Roncero
+ * - Javier Álvarez Páramo
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <omp.h>
+#include "ordena.h"
+#include "instrumentacion.h"
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define BLOQUE_COMPROBACION 4096 // Componentes que revisa un hilo entre dos consultas del indicador de parada
+#define ALINEAMIENTO 64			 // Línea de caché: ningún trozo estático de un hilo comparte línea con el del vecino por el inicio
+#define PAGINA 4096
+#define PAGINA_GRANDE (2 * 1024 * 1024)
+
+int paginas_grandes = FALSE; // TRUE para pedir páginas grandes (transparent huge pages) en las reservas de al menos 2 MB
+
+// posix_memalign con el alineamiento de reservaAlineada (y la sugerencia de páginas grandes), sin el primer acceso
+void *reserva_sin_tocar(long bytes)
+{
+	void *p;
+	size_t alineamiento = (paginas_grandes && (bytes >= PAGINA_GRANDE)) ? PAGINA_GRANDE : ALINEAMIENTO;
+
+	if (posix_memalign(&p, alineamiento, (bytes > 0) ? bytes : 1) != 0)
+		return NULL;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	if (alineamiento == PAGINA_GRANDE)
+		madvise(p, bytes & ~(long)(PAGINA_GRANDE - 1), MADV_HUGEPAGE); // Solo es una sugerencia: si falla se usan páginas normales
+#endif
+	return p;
+}
+
+/* Reserva bytes alineados a ALINEAMIENTO (a PAGINA_GRANDE si se piden páginas grandes y la reserva es al menos de ese tamaño)
+ * y hace el primer acceso en paralelo con el mismo reparto estático que usan los métodos. Linux coloca cada página en el nodo
+ * de memoria del hilo que la toca primero, así que, en una máquina con varios zócalos, el trozo de cada hilo queda en su nodo.
+ * Basta con escribir un byte por página: el núcleo ya entrega las páginas a cero. Se libera con liberaAlineada.
+ */
+void *reservaAlineada(long bytes)
+{
+	void *p = reserva_sin_tocar(bytes);
+	long pag, npaginas = (bytes + PAGINA - 1) / PAGINA;
+
+	if (p == NULL)
+		return NULL;
+	#pragma omp parallel for schedule(static)
+	for (pag = 0; pag < npaginas; pag++)
+		((char *)p)[pag * PAGINA] = 0;
+	return p;
+}
+
+void toca_paginas(struct ejecutor *e, const struct tarea *t)
+{
+	long pag;
+	(void)e;
+	for (pag = t->ini; pag < t->fin; pag++)
+		((char *)t->datos)[pag * PAGINA] = 0;
+}
+
+// Como reservaAlineada, pero el primer acceso lo hacen los hilos del ejecutor, que son los que después usan la memoria
+void *reservaAlineada_ejecutor(struct ejecutor *e, long bytes)
+{
+	void *p = reserva_sin_tocar(bytes);
+	if (p != NULL)
+		e->para(e, (bytes + PAGINA - 1) / PAGINA, toca_paginas, p);
+	return p;
+}
+
+void liberaAlineada(void *p)
+{
+	free(p); // posix_memalign reserva memoria que se libera con free
+}
+
+float *reservaVector(int size)
+{
+	return (float *)reservaAlineada((long)size * sizeof(float));
+}
+
+void copiarVector(float Vdest[], float V[], int size)
+{
+	int i;
+	// Reparto estático, igual que el primer acceso de reservaAlineada: cada hilo copia las páginas que tiene en su nodo
+	#pragma omp parallel for schedule(static)
+	for (i = 0; i < size; ++i)
+		Vdest[i] = V[i];
+}
+
+struct copia_vector
+{
+	float *destino;
+	const float *origen;
+};
+
+void copia_trozo(struct ejecutor *e, const struct tarea *t)
+{
+	struct copia_vector *c = (struct copia_vector *)t->datos;
+	(void)e;
+	memcpy(c->destino + t->ini, c->origen + t->ini, (t->fin - t->ini) * sizeof(float));
+}
+
+// copiarVector en los hilos de un ejecutor: cada trozo se copia con memcpy
+void copiarVector_ejecutor(struct ejecutor *e, float Vdest[], float V[], int size)
+{
+	struct copia_vector c = {Vdest, V};
+	e->para(e, size, copia_trozo, &c);
+}
+
+void printVector(float vector[], int size)
+{
+	/* 
+   * Este bucle for no se puede paralelizar porque al distribuir las distintas iteraciones entre los distintos hilos
+   * pueden existir hilos que tarden menos que otros y en consecuencia algunas iteraciones se impriman antes que otras
+   * alterando el orden original de vector.
+   */
+	for (int i = 0; i < size; ++i)
+		printf("%0.4f\t", vector[i]);
+	printf("\n\n");
+}
+
+/* Índice i del primer par desordenado (vector[i] <= vector[i+1] no se cumple) o -1 si el vector está ordenado.
+ *
+ * El do-while original no se podía paralelizar tal cual porque su condición de salida depende de los datos y OpenMP no admite
+ * "break" dentro de un "omp for". Aquí cada hilo recorre por su cuenta un trozo estático de los pares (i, i+1), de modo que el
+ * último componente de un trozo se compara también con el primero del siguiente. El trozo se revisa por bloques de
+ * BLOQUE_COMPROBACION con una reducción vectorizable (sin saltos dentro del bloque) y solo si el bloque tiene algún desorden
+ * se busca su posición exacta. El menor índice encontrado se comparte en "primero": antes de cada bloque el hilo lo consulta
+ * y deja de trabajar si ya hay un desorden antes de ese bloque, así que se para pronto sin perder el primero.
+ */
+int primerDesorden(float vector[], int size)
+{
+	int primero = size;
+
+	#pragma omp parallel
+	{
+		int b, i, fb, desorden, actual, t = omp_get_thread_num(), nt = omp_get_num_threads();
+		int ini = (long)t * (size - 1) / nt, fin = (long)(t + 1) * (size - 1) / nt; // pares (i, i+1) con ini <= i < fin
+
+		for (b = ini; b < fin; b = fb)
+		{
+			#pragma omp atomic read
+			actual = primero;
+			if (actual <= b)
+				break;
+			fb = min(b + BLOQUE_COMPROBACION, fin);
+			desorden = FALSE;
+			#pragma omp simd reduction(| : desorden)
+			for (i = b; i < fb; i++)
+				desorden |= !(vector[i] <= vector[i + 1]);
+			if (desorden)
+			{
+				for (i = b; vector[i] <= vector[i + 1]; i++)
+					;
+				#pragma omp critical(primer_desorden)
+				{
+					#pragma omp atomic read
+					actual = primero;
+					if (i < actual)
+					{
+						#pragma omp atomic write
+						primero = i;
+					}
+				}
+				break;
+			}
+		}
+	}
+	return (primero == size) ? -1 : primero;
+}
+
+struct desorden
+{
+	const float *vector;
+	int primero; // menor desorden encontrado hasta ahora (el tamaño si ninguno)
+};
+
+// Lo que hace cada hilo en primerDesorden, sobre los pares (i, i+1) del trozo; el menor índice se deja con un CAS
+void busca_desorden(struct ejecutor *e, const struct tarea *t)
+{
+	struct desorden *d = (struct desorden *)t->datos;
+	const float *vector = d->vector;
+	int b, i, fb, desorden, actual, fin = t->fin;
+	(void)e;
+
+	for (b = t->ini; b < fin; b = fb)
+	{
+		if (__atomic_load_n(&d->primero, __ATOMIC_RELAXED) <= b)
+			break;
+		fb = min(b + BLOQUE_COMPROBACION, fin);
+		desorden = FALSE;
+		#pragma omp simd reduction(| : desorden)
+		for (i = b; i < fb; i++)
+			desorden |= !(vector[i] <= vector[i + 1]);
+		if (desorden)
+		{
+			for (i = b; vector[i] <= vector[i + 1]; i++)
+				;
+			actual = __atomic_load_n(&d->primero, __ATOMIC_RELAXED);
+			while ((i < actual) && !__atomic_compare_exchange_n(&d->primero, &actual, i, FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				;
+			break;
+		}
+	}
+}
+
+// primerDesorden en los hilos de un ejecutor
+int primerDesorden_ejecutor(struct ejecutor *e, float vector[], int size)
+{
+	struct desorden d = {vector, size};
+	if (size > 1)
+		e->para(e, size - 1, busca_desorden, &d);
+	return (d.primero == size) ? -1 : d.primero;
+}
+
+int estaOrdenado(float vector[], int size)
+{
+	return primerDesorden(vector, size) < 0; // TRUE (1) si el vector está ordenado y FALSE (0) en caso contrario
+}
+
+// TRUE si a[ini..fin-1] y b[ini..fin-1] tienen algún componente distinto (comparación vectorizable, sin saltos dentro del bloque)
+int bloque_distinto(const float a[], const float b[], int ini, int fin)
+{
+	int i, distinto = FALSE;
+	#pragma omp simd reduction(| : distinto)
+	for (i = ini; i < fin; i++)
+		distinto |= (a[i] != b[i]);
+	return distinto;
+}
+
+/* Los vectores se comparan por bloques de BLOQUE_COMPROBACION repartidos estáticamente entre los hilos. El resultado es una
+ * reducción AND lógica (sin sección crítica) y, en cuanto un hilo encuentra una diferencia, activa "parar" para que el resto
+ * de hilos se salten los bloques que les quedan. Cuando son iguales se hace una sola pasada, al ritmo de la memoria.
+ */
+int vectoresIguales(float vecta[], float vectb[], int size)
+{
+	int bloque, iguales = TRUE, parar = FALSE, nbloques = (size + BLOQUE_COMPROBACION - 1) / BLOQUE_COMPROBACION;
+
+	#pragma omp parallel for schedule(static) reduction(&& : iguales)
+	for (bloque = 0; bloque < nbloques; bloque++)
+	{
+		int p, ini = bloque * BLOQUE_COMPROBACION;
+		#pragma omp atomic read
+		p = parar;
+		if (!p && bloque_distinto(vecta, vectb, ini, min(ini + BLOQUE_COMPROBACION, size)))
+		{
+			iguales = FALSE;
+			#pragma omp atomic write
+			parar = TRUE;
+		}
+	}
+	return iguales;
+}
+
+/* Índice del primer componente en el que difieren los dos vectores o -1 si son iguales (para depurar cuando vectoresIguales
+ * falla). Con el reparto estático cada hilo recorre sus bloques en orden, así que deja de comparar en cuanto encuentra una
+ * diferencia; la reducción min se queda con la primera de todas.
+ */
+int primeraDiferencia(float vecta[], float vectb[], int size)
+{
+	int bloque, primera = INT_MAX, nbloques = (size + BLOQUE_COMPROBACION - 1) / BLOQUE_COMPROBACION;
+
+	// La copia privada de una reducción min empieza en INT_MAX, que sirve de marca de "sin diferencias"
+	#pragma omp parallel for schedule(static) reduction(min : primera)
+	for (bloque = 0; bloque < nbloques; bloque++)
+	{
+		int i, ini = bloque * BLOQUE_COMPROBACION, fin = min(ini + BLOQUE_COMPROBACION, size);
+		if ((primera == INT_MAX) && bloque_distinto(vecta, vectb, ini, fin))
+		{
+			for (i = ini; vecta[i] == vectb[i]; i++)
+				;
+			primera = i;
+		}
+	}
+	return (primera == INT_MAX) ? -1 : primera;
+}
+
+int compara_bits(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+/* TRUE si los dos vectores tienen los mismos componentes, bit a bit, aunque sea en otro orden (+0 y -0 son distintos y cada
+ * NaN cuenta con su representación). Ordena una copia de cada uno con qsort: es solo para comprobar resultados.
+ */
+int esPermutacion(const float vecta[], const float vectb[], int size)
+{
+	uint32_t *a = (uint32_t *)malloc((long)size * sizeof(uint32_t)), *b = (uint32_t *)malloc((long)size * sizeof(uint32_t));
+	int iguales = (a != NULL) && (b != NULL);
+	if (iguales)
+	{
+		memcpy(a, vecta, (long)size * sizeof(float));
+		memcpy(b, vectb, (long)size * sizeof(float));
+		qsort(a, size, sizeof(uint32_t), compara_bits);
+		qsort(b, size, sizeof(uint32_t), compara_bits);
+		iguales = (memcmp(a, b, (long)size * sizeof(uint32_t)) == 0);
+	}
+	free(a);
+	free(b);
+	return iguales;
+}
+
+/* Función que mezcla dos fragmentos ordenados contiguos de un vector en un solo fragmento ordenado
+ * Fragmentos ordenados de entrada: (vector[ini1]... vector[ini2-1]),		(vector[ini2]... vector[fin2])
+ * Fragmento ordenado que contiene el resultado:	(vector[ini1]... vector[ini2-1], vector[ini2]... vector[fin2]) 
+ * Con paralela == FALSE es la mezcla de ord_secA y con paralela == TRUE la de ord_parA.
+*/
+void mezcla_ordenada(float vector[], int ini1, int ini2, int fin2, int paralela)
+{
+	int i, j, k, terminado = 0;
+	float temp;
+	i = ini1;
+	j = ini2;
+	do
+	{													// vector[ini1] <=...<= vector[j-1] AND vector[j] <=...<= vector[fin2] AND i < j
+		while ((vector[i] <= vector[j]) && (i < j - 1)) // 2a condicion para que no adelante i a j (solo se produce al final)
+		{
+			INS_COMPARA(1);
+			i++;
+		}
+		INS_COMPARA(2); // la que termina el while y la del if
+		if (vector[i] > vector[j])
+		{
+			INS_MUEVE(j - i + 1); // la rotación
+			/* Rotamos vector[i], vector[i+1], ...,vector[j-1], vector[j]
+					 * para que vector[j] pase a la posición i y el resto se desplace una posición a la derecha */
+			temp = vector[j];
+			if (paralela)
+			{ // Solo ord_parA reparte el desplazamiento entre hilos (con la cláusula if se seguiría abriendo una región por elemento)
+				#pragma omp parallel for schedule(dynamic)
+				for (k = j; k > i; k--)
+					vector[k] = vector[k - 1];
+			}
+			else
+				for (k = j; k > i; k--)
+					vector[k] = vector[k - 1];
+			vector[i] = temp;
+			if (j == fin2)
+				terminado = 1;
+			// Hemos colocado en su posición el último elemento del segundo fragmento
+			else
+			{
+				j++;
+				i++;
+			}
+		}
+		// vector[ini1] <=...<= vector[j-1] AND vector[j] <=...<= vector[fin2] AND i < j
+		else
+			terminado = 1;
+		/* i == j-1 AND vector[i] <= vector[j], 
+				 * luego vector[j-1] <= vector[j] y todo queda ordenado*/
+	} while (!terminado);
+}